@@ -0,0 +1,115 @@
+#pragma once
+
+#include "csr_graph.h"
+#include "graph.h"
+#include "router.h"
+#include "search_workspace.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Dijkstra guided by a lower bound of the remaining route weight, settles only the vertexes whose
+// weight plus bound doesn't exceed the route; the bound must be consistent:
+// bound(u, to) <= edge(u, v).weight + bound(v, to) and bound(to, to) == 0; queries search in the workspace
+// of the calling thread, so they run concurrently if the bound can be called concurrently
+template <typename Weight>
+class AStarRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+    using LowerBound = std::function<Weight(VertexId from, VertexId to)>;
+
+    AStarRouter(const Graph& graph, LowerBound lower_bound);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+private:
+    using Workspace = SearchWorkspace<Weight>;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    CsrGraph<Weight> csr_graph_;
+    LowerBound lower_bound_;
+};
+
+template <typename Weight>
+AStarRouter<Weight>::AStarRouter(const Graph& graph, LowerBound lower_bound)
+: graph_(graph)
+, csr_graph_(graph)
+, lower_bound_(std::move(lower_bound))
+{
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename AStarRouter<Weight>::RouteInfo> AStarRouter<Weight>::BuildRoute(VertexId from,
+                                                                                       VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    Workspace& workspace = GetThreadSearchWorkspace<Weight>();
+    workspace.Reset(vertex_count);
+
+    // the queue is ordered by the weight so far plus the bound of the rest,
+    // the bound is computed once per reached vertex, not once per edge
+    workspace.Reach(from, ZERO_WEIGHT);
+    workspace.Push(lower_bound_(from, to), from);
+
+    while (!workspace.IsQueueEmpty()) {
+        const VertexId vertex = workspace.GetQueueTop().second;
+        workspace.Pop();
+        if (workspace.IsSettled(vertex)) {
+            continue;
+        }
+        workspace.Settle(vertex);
+        if (vertex == to) {
+            break;
+        }
+
+        const Weight weight = workspace.GetWeight(vertex);
+        for (const auto& arc : csr_graph_.GetArcs(vertex)) {
+            if (workspace.IsSettled(arc.to)) {
+                continue;
+            }
+            const Weight candidate_weight = weight + arc.weight;
+            if (!workspace.IsReached(arc.to) || candidate_weight < workspace.GetWeight(arc.to)) {
+                workspace.Reach(arc.to, candidate_weight, arc.edge_id);
+                if (!workspace.HasBound(arc.to)) {
+                    workspace.SetBound(arc.to, lower_bound_(arc.to, to));
+                }
+                workspace.Push(candidate_weight + workspace.GetBound(arc.to), arc.to);
+            }
+        }
+    }
+
+    if (!workspace.IsReached(to)) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = workspace.GetPrevEdge(to);
+         edge_id != Workspace::NO_EDGE;
+         edge_id = workspace.GetPrevEdge(graph_.GetEdge(edge_id).from))
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{workspace.GetWeight(to), std::move(edges)};
+}
+
+}  // namespace graph
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "csr_graph.h"
+#include "graph.h"
+#include "router.h"
+#include "search_workspace.h"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// answers every query with two Dijkstra searches, forward from the start over the outgoing edges and
+// backward from the finish over the incoming ones; stops once the tops of the two queues together
+// reach the best route met so far, so each search covers about half the radius of a one-way search;
+// the two searches run in the two workspaces of the calling thread, so queries run concurrently
+template <typename Weight>
+class BidirectionalDijkstraRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+
+    explicit BidirectionalDijkstraRouter(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+private:
+    using Workspace = SearchWorkspace<Weight>;
+
+    static constexpr size_t FORWARD = 0;
+    static constexpr size_t BACKWARD = 1;
+
+    // starts the search in one direction, its previous edges lead back to the vertex it starts from
+    static Workspace& StartSearch(size_t direction, size_t vertex_count, VertexId start);
+
+    // drops the entries of the vertexes settled already, returns nullopt if the queue ends
+    static std::optional<Weight> GetTopWeight(Workspace& search);
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    // forward arcs lead along the edges, backward arcs against them
+    std::array<CsrGraph<Weight>, 2> csr_graphs_;
+};
+
+template <typename Weight>
+BidirectionalDijkstraRouter<Weight>::BidirectionalDijkstraRouter(const Graph& graph)
+: graph_(graph)
+, csr_graphs_{CsrGraph<Weight>(graph, CsrGraph<Weight>::Direction::FORWARD),
+              CsrGraph<Weight>(graph, CsrGraph<Weight>::Direction::BACKWARD)}
+{
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename BidirectionalDijkstraRouter<Weight>::RouteInfo>
+BidirectionalDijkstraRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    const std::array<Workspace*, 2> searches{&StartSearch(FORWARD, vertex_count, from),
+                                             &StartSearch(BACKWARD, vertex_count, to)};
+
+    // the best route met so far goes through meeting_vertex
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = from;
+    if (from == to) {
+        best_weight = ZERO_WEIGHT;
+    }
+
+    while (true) {
+        const std::optional<Weight> forward_top = GetTopWeight(*searches[FORWARD]);
+        const std::optional<Weight> backward_top = GetTopWeight(*searches[BACKWARD]);
+        // a search that ran out of vertexes has fixed the weights of all it reaches,
+        // so every route has been met already
+        if (!forward_top || !backward_top) {
+            break;
+        }
+        // no route through an unsettled vertex is lighter than the tops together
+        if (best_weight && !(*forward_top + *backward_top < *best_weight)) {
+            break;
+        }
+
+        const size_t direction = *backward_top < *forward_top ? BACKWARD : FORWARD;
+        Workspace& search = *searches[direction];
+        const Workspace& opposite = *searches[1 - direction];
+
+        const auto [weight, vertex] = search.GetQueueTop();
+        search.Pop();
+        search.Settle(vertex);
+
+        for (const auto& arc : csr_graphs_[direction].GetArcs(vertex)) {
+            const Weight candidate_weight = weight + arc.weight;
+            if (!search.IsReached(arc.to) || candidate_weight < search.GetWeight(arc.to)) {
+                search.Reach(arc.to, candidate_weight, arc.edge_id);
+                search.Push(candidate_weight, arc.to);
+            }
+            if (opposite.IsReached(arc.to)) {
+                const Weight route_weight = search.GetWeight(arc.to) + opposite.GetWeight(arc.to);
+                if (!best_weight || route_weight < *best_weight) {
+                    best_weight = route_weight;
+                    meeting_vertex = arc.to;
+                }
+            }
+        }
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    // the forward half is unwound from the meeting vertex back to the start, the backward one
+    // from the meeting vertex on to the finish
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = searches[FORWARD]->GetPrevEdge(meeting_vertex);
+         edge_id != Workspace::NO_EDGE;
+         edge_id = searches[FORWARD]->GetPrevEdge(graph_.GetEdge(edge_id).from))
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    for (EdgeId edge_id = searches[BACKWARD]->GetPrevEdge(meeting_vertex);
+         edge_id != Workspace::NO_EDGE;
+         edge_id = searches[BACKWARD]->GetPrevEdge(graph_.GetEdge(edge_id).to))
+    {
+        edges.push_back(edge_id);
+    }
+
+    // the weights of the halves are summed the same way as any other route
+    return RouteInfo{searches[FORWARD]->GetWeight(meeting_vertex) + searches[BACKWARD]->GetWeight(meeting_vertex),
+                     std::move(edges)};
+}
+
+template <typename Weight>
+typename BidirectionalDijkstraRouter<Weight>::Workspace& BidirectionalDijkstraRouter<Weight>::StartSearch(
+    size_t direction, size_t vertex_count, VertexId start) {
+    Workspace& search = GetThreadSearchWorkspace<Weight>(direction);
+    search.Reset(vertex_count);
+    search.Reach(start, ZERO_WEIGHT);
+    search.Push(ZERO_WEIGHT, start);
+    return search;
+}
+
+template <typename Weight>
+std::optional<Weight> BidirectionalDijkstraRouter<Weight>::GetTopWeight(Workspace& search) {
+    while (!search.IsQueueEmpty() && search.IsSettled(search.GetQueueTop().second)) {
+        search.Pop();
+    }
+    if (search.IsQueueEmpty()) {
+        return std::nullopt;
+    }
+    return search.GetQueueTop().first;
+}
+
+}  // namespace graph
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "csr_graph.h"
+#include "graph.h"
+#include "search_workspace.h"
+
+#include <stdexcept>
+#include <vector>
+
+namespace graph {
+
+// finds every vertex within a weight budget of a start vertex with one Dijkstra search that stops at the budget;
+// a backward search runs against the edges and finds the vertexes the start can be reached from;
+// searches run in the workspace of the calling thread
+template <typename Weight>
+class BoundedSearch {
+public:
+    using Direction = typename CsrGraph<Weight>::Direction;
+
+    struct ReachedVertex {
+        VertexId vertex;
+        Weight weight;
+    };
+
+    // the graphs are the same graph along and against its edges, they must outlive the search
+    BoundedSearch(const CsrGraph<Weight>& forward_graph, const CsrGraph<Weight>& backward_graph);
+
+    // the reached vertexes in the order of their weights, the start included
+    std::vector<ReachedVertex> Search(VertexId start, Weight max_weight, Direction direction) const;
+
+private:
+    static constexpr Weight ZERO_WEIGHT{};
+    const CsrGraph<Weight>& forward_graph_;
+    const CsrGraph<Weight>& backward_graph_;
+};
+
+template <typename Weight>
+BoundedSearch<Weight>::BoundedSearch(const CsrGraph<Weight>& forward_graph, const CsrGraph<Weight>& backward_graph)
+: forward_graph_(forward_graph)
+, backward_graph_(backward_graph)
+{
+    for (VertexId vertex = 0; vertex < forward_graph.GetVertexCount(); ++vertex) {
+        for (const auto& arc : forward_graph.GetArcs(vertex)) {
+            if (arc.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+}
+
+template <typename Weight>
+std::vector<typename BoundedSearch<Weight>::ReachedVertex> BoundedSearch<Weight>::Search(VertexId start,
+                                                                                       Weight max_weight,
+                                                                                       Direction direction) const {
+    const CsrGraph<Weight>& csr_graph = direction == Direction::FORWARD ? forward_graph_ : backward_graph_;
+    const size_t vertex_count = csr_graph.GetVertexCount();
+    if (start >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    std::vector<ReachedVertex> reached;
+    if (max_weight < ZERO_WEIGHT) {
+        return reached;
+    }
+
+    SearchWorkspace<Weight>& workspace = GetThreadSearchWorkspace<Weight>();
+    workspace.Reset(vertex_count);
+    workspace.Reach(start, ZERO_WEIGHT);
+    workspace.Push(ZERO_WEIGHT, start);
+
+    // only weights within the budget enter the queue, so it runs out right at the budget
+    while (!workspace.IsQueueEmpty()) {
+        const auto [weight, vertex] = workspace.GetQueueTop();
+        workspace.Pop();
+        if (workspace.IsSettled(vertex)) {
+            continue;
+        }
+        workspace.Settle(vertex);
+        reached.push_back({vertex, weight});
+
+        for (const auto& arc : csr_graph.GetArcs(vertex)) {
+            const Weight candidate_weight = weight + arc.weight;
+            if (max_weight < candidate_weight) {
+                continue;
+            }
+            if (!workspace.IsReached(arc.to) || candidate_weight < workspace.GetWeight(arc.to)) {
+                workspace.Reach(arc.to, candidate_weight);
+                workspace.Push(candidate_weight, arc.to);
+            }
+        }
+    }
+
+    return reached;
+}
+
+}  // namespace graph
@@ -0,0 +1,260 @@
+#pragma once
+
+#include "csr_graph.h"
+#include "graph.h"
+#include "router.h"
+#include "search_workspace.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace graph {
+
+// all routes like Router, but only the last edge of every route in 16 or 32 bits, filled by a Dijkstra
+// search from every vertex; a query walks the edges back and sums their weights
+template <typename Weight>
+class CompactRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+
+    // searches the rows on the pool, or on the calling thread without one
+    explicit CompactRouter(const Graph& graph, concurrency::ThreadPool* thread_pool = nullptr);
+
+    CompactRouter(const Graph& graph, std::istream& input);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    void Save(std::ostream& output) const;
+
+    // 2 or 4
+    size_t GetCellSize() const { return short_prev_edges_.empty() ? sizeof(uint32_t) : sizeof(uint16_t); }
+
+private:
+    using Workspace = SearchWorkspace<Weight>;
+
+    template <typename PrevEdgeId>
+    static constexpr PrevEdgeId NO_EDGE = std::numeric_limits<PrevEdgeId>::max();
+
+    template <typename PrevEdgeId>
+    void SearchRows(std::vector<PrevEdgeId>& prev_edges, concurrency::ThreadPool* thread_pool) const;
+
+    template <typename PrevEdgeId>
+    std::optional<RouteInfo> BuildRoute(const std::vector<PrevEdgeId>& prev_edges, VertexId from,
+                                        VertexId to) const;
+
+    template <typename PrevEdgeId>
+    void ReadTable(std::istream& input, std::vector<PrevEdgeId>& prev_edges);
+
+    // whether the edges of the row lead from its vertex to every vertex that has one, so walking them back ends
+    template <typename PrevEdgeId>
+    bool IsRouteTree(const PrevEdgeId* row, VertexId from, std::vector<uint8_t>& states) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    size_t vertex_count_;
+    // one of them holds the V x V row-major table, NO_EDGE where there is no route or the route has no edges
+    std::vector<uint16_t> short_prev_edges_;
+    std::vector<uint32_t> prev_edges_;
+};
+
+template <typename Weight>
+CompactRouter<Weight>::CompactRouter(const Graph& graph, concurrency::ThreadPool* thread_pool)
+: graph_(graph)
+, vertex_count_(graph.GetVertexCount())
+{
+    if (graph.GetEdgeCount() >= NO_EDGE<uint32_t>) {
+        throw std::length_error("Too many edges for all-pairs router");
+    }
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+
+    if (graph.GetEdgeCount() < NO_EDGE<uint16_t>) {
+        SearchRows(short_prev_edges_, thread_pool);
+    } else {
+        SearchRows(prev_edges_, thread_pool);
+    }
+}
+
+template <typename Weight>
+CompactRouter<Weight>::CompactRouter(const Graph& graph, std::istream& input)
+: graph_(graph)
+, vertex_count_(graph.GetVertexCount())
+{
+    uint64_t vertex_count = 0;
+    uint64_t cell_size = 0;
+    input.read(reinterpret_cast<char*>(&vertex_count), sizeof(vertex_count));
+    input.read(reinterpret_cast<char*>(&cell_size), sizeof(cell_size));
+    // the table is sized to the edges, so a graph of the same vertexes may still not match it
+    const uint64_t expected_cell_size =
+        graph.GetEdgeCount() < NO_EDGE<uint16_t> ? sizeof(uint16_t) : sizeof(uint32_t);
+    if (!input || vertex_count != vertex_count_ || cell_size != expected_cell_size) {
+        throw std::invalid_argument("All-pairs table doesn't match the graph");
+    }
+
+    if (cell_size == sizeof(uint16_t)) {
+        ReadTable(input, short_prev_edges_);
+    } else {
+        ReadTable(input, prev_edges_);
+    }
+}
+
+template <typename Weight>
+std::optional<typename CompactRouter<Weight>::RouteInfo> CompactRouter<Weight>::BuildRoute(VertexId from,
+                                                                                           VertexId to) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (short_prev_edges_.empty()) {
+        return BuildRoute(prev_edges_, from, to);
+    }
+    return BuildRoute(short_prev_edges_, from, to);
+}
+
+template <typename Weight>
+void CompactRouter<Weight>::Save(std::ostream& output) const {
+    const uint64_t vertex_count = vertex_count_;
+    const uint64_t cell_size = GetCellSize();
+    output.write(reinterpret_cast<const char*>(&vertex_count), sizeof(vertex_count));
+    output.write(reinterpret_cast<const char*>(&cell_size), sizeof(cell_size));
+    if (short_prev_edges_.empty()) {
+        output.write(reinterpret_cast<const char*>(prev_edges_.data()),
+                     static_cast<std::streamsize>(sizeof(uint32_t) * prev_edges_.size()));
+    } else {
+        output.write(reinterpret_cast<const char*>(short_prev_edges_.data()),
+                     static_cast<std::streamsize>(sizeof(uint16_t) * short_prev_edges_.size()));
+    }
+}
+
+template <typename Weight>
+template <typename PrevEdgeId>
+void CompactRouter<Weight>::SearchRows(std::vector<PrevEdgeId>& prev_edges,
+                                       concurrency::ThreadPool* thread_pool) const {
+    prev_edges.assign(vertex_count_ * vertex_count_, NO_EDGE<PrevEdgeId>);
+    const CsrGraph<Weight> csr_graph(graph_);
+
+    // a row is written only by its own task
+    concurrency::ParallelFor(thread_pool, 0, vertex_count_, [this, &prev_edges, &csr_graph](size_t vertex_from) {
+        Workspace& workspace = GetThreadSearchWorkspace<Weight>();
+        workspace.Reset(vertex_count_);
+        workspace.Reach(vertex_from, ZERO_WEIGHT);
+        workspace.Push(ZERO_WEIGHT, vertex_from);
+        while (!workspace.IsQueueEmpty()) {
+            const auto [weight, vertex] = workspace.GetQueueTop();
+            workspace.Pop();
+            if (workspace.IsSettled(vertex)) {
+                continue;
+            }
+            workspace.Settle(vertex);
+
+            for (const auto& arc : csr_graph.GetArcs(vertex)) {
+                const Weight candidate_weight = weight + arc.weight;
+                if (!workspace.IsReached(arc.to) || candidate_weight < workspace.GetWeight(arc.to)) {
+                    workspace.Reach(arc.to, candidate_weight, arc.edge_id);
+                    workspace.Push(candidate_weight, arc.to);
+                }
+            }
+        }
+
+        PrevEdgeId* row = &prev_edges[vertex_from * vertex_count_];
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            if (vertex != vertex_from && workspace.IsReached(vertex)) {
+                row[vertex] = static_cast<PrevEdgeId>(workspace.GetPrevEdge(vertex));
+            }
+        }
+    });
+}
+
+template <typename Weight>
+template <typename PrevEdgeId>
+std::optional<typename CompactRouter<Weight>::RouteInfo> CompactRouter<Weight>::BuildRoute(
+    const std::vector<PrevEdgeId>& prev_edges, VertexId from, VertexId to) const {
+    const PrevEdgeId* row = &prev_edges[from * vertex_count_];
+    if (from != to && row[to] == NO_EDGE<PrevEdgeId>) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (VertexId vertex = to; vertex != from; vertex = graph_.GetEdge(edges.back()).from) {
+        edges.push_back(row[vertex]);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : edges) {
+        weight += graph_.GetEdge(edge_id).weight;
+    }
+    return RouteInfo{weight, std::move(edges)};
+}
+
+template <typename Weight>
+template <typename PrevEdgeId>
+void CompactRouter<Weight>::ReadTable(std::istream& input, std::vector<PrevEdgeId>& prev_edges) {
+    prev_edges.resize(vertex_count_ * vertex_count_);
+    input.read(reinterpret_cast<char*>(prev_edges.data()),
+               static_cast<std::streamsize>(sizeof(PrevEdgeId) * prev_edges.size()));
+    if (!input) {
+        throw std::invalid_argument("All-pairs table is truncated");
+    }
+    for (const PrevEdgeId edge_id : prev_edges) {
+        if (edge_id != NO_EDGE<PrevEdgeId> && edge_id >= graph_.GetEdgeCount()) {
+            throw std::invalid_argument("All-pairs table doesn't match the graph");
+        }
+    }
+    std::vector<uint8_t> states;
+    for (VertexId from = 0; from < vertex_count_; ++from) {
+        if (!IsRouteTree(&prev_edges[from * vertex_count_], from, states)) {
+            throw std::invalid_argument("All-pairs table doesn't match the graph");
+        }
+    }
+}
+
+template <typename Weight>
+template <typename PrevEdgeId>
+bool CompactRouter<Weight>::IsRouteTree(const PrevEdgeId* row, VertexId from, std::vector<uint8_t>& states) const {
+    enum : uint8_t { UNSEEN, ON_PATH, ROOTED };
+
+    if (row[from] != NO_EDGE<PrevEdgeId>) {
+        return false;
+    }
+    states.assign(vertex_count_, UNSEEN);
+    states[from] = ROOTED;
+    std::vector<VertexId> path;
+    for (VertexId to = 0; to < vertex_count_; ++to) {
+        if (row[to] == NO_EDGE<PrevEdgeId>) {
+            continue;
+        }
+        VertexId vertex = to;
+        while (states[vertex] == UNSEEN) {
+            if (row[vertex] == NO_EDGE<PrevEdgeId> || graph_.IsEdgeRemoved(row[vertex]) ||
+                graph_.GetEdge(row[vertex]).to != vertex) {
+                return false;
+            }
+            states[vertex] = ON_PATH;
+            path.push_back(vertex);
+            vertex = graph_.GetEdge(row[vertex]).from;
+        }
+        if (states[vertex] == ON_PATH) {
+            return false;
+        }
+        for (const VertexId path_vertex : path) {
+            states[path_vertex] = ROOTED;
+        }
+        path.clear();
+    }
+    return true;
+}
+
+}  // namespace graph
@@ -0,0 +1,648 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+#include "search_workspace.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// contracts vertexes in the order of importance adding shortcuts, a query searches up the hierarchy from both ends
+template <typename Weight>
+class ContractionHierarchyRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+
+    // contracts on the pool, or on the calling thread without one
+    explicit ContractionHierarchyRouter(const Graph& graph, concurrency::ThreadPool* thread_pool = nullptr);
+
+    // loads a hierarchy written by Save for the same graph
+    ContractionHierarchyRouter(const Graph& graph, std::istream& input);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    void Save(std::ostream& output) const;
+
+    size_t GetShortcutCount() const { return edges_.size() - original_edge_count_; }
+
+private:
+    using Index = uint32_t;
+
+    static constexpr Index NONE = std::numeric_limits<Index>::max();
+    static constexpr Weight ZERO_WEIGHT{};
+    // a witness search gives up after settling this many vertexes and lets a shortcut in,
+    // the priority only estimates the shortcuts and affords a much shorter search
+    static constexpr size_t WITNESS_SETTLED_LIMIT = 500;
+    static constexpr size_t PRIORITY_SETTLED_LIMIT = 30;
+
+    // an original edge has no halves, a shortcut u->w replaces the edges u->v and v->w
+    struct HierarchyEdge {
+        Index from;
+        Index to;
+        Weight weight;
+        Index first_half = NONE;
+        Index second_half = NONE;
+    };
+
+    struct Arc {
+        Index to;
+        Index edge;
+        Weight weight;
+    };
+
+    struct Shortcut {
+        Index first_half;
+        Index second_half;
+    };
+
+    // Dijkstra from one neighbour of a contracted vertex to its other neighbours avoiding the vertex
+    class WitnessSearch {
+    public:
+        explicit WitnessSearch(size_t vertex_count)
+        : weights_(vertex_count), reached_(vertex_count, false), is_target_(vertex_count, false) {}
+
+        // a search stops as soon as it has settled all the targets
+        void SetTargets(const std::vector<Index>& targets) {
+            for (const Index vertex : targets_) {
+                is_target_[vertex] = false;
+            }
+            targets_ = targets;
+            for (const Index vertex : targets_) {
+                is_target_[vertex] = true;
+            }
+        }
+
+        void Run(const ContractionHierarchyRouter& router, Index from, Index avoided, Weight max_weight,
+                 size_t settled_limit);
+
+        std::optional<Weight> GetWeight(Index vertex) const {
+            return reached_[vertex] ? std::optional<Weight>(weights_[vertex]) : std::nullopt;
+        }
+
+    private:
+        std::vector<Weight> weights_;
+        std::vector<bool> reached_;
+        std::vector<Index> touched_;
+        std::vector<bool> is_target_;
+        std::vector<Index> targets_;
+    };
+
+    using QueueItem = std::pair<Weight, Index>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    // the contraction works on growing incidence lists, stale entries are skipped by the contracted flag
+    std::vector<Shortcut> FindShortcuts(Index vertex, WitnessSearch& witness_search, size_t settled_limit) const;
+
+    int ComputePriority(Index vertex, WitnessSearch& witness_search) const;
+
+    // drops the edges of contracted vertexes and all but the lightest edge to every neighbour
+    void CompactEdges(Index vertex);
+
+    void Contract(concurrency::ThreadPool* thread_pool);
+
+    void BuildSearchGraphs();
+
+    void UnpackEdge(Index edge, std::vector<EdgeId>& edges) const;
+
+    size_t vertex_count_;
+    size_t original_edge_count_;
+    std::vector<HierarchyEdge> edges_;
+    std::vector<Index> ranks_;
+
+    // preprocessing only
+    std::vector<std::vector<Index>> out_edges_;
+    std::vector<std::vector<Index>> in_edges_;
+    std::vector<bool> contracted_;
+    std::vector<int> contracted_neighbours_;
+
+    // arcs to higher ranked vertexes, and reversed arcs from higher ranked vertexes, in CSR form
+    std::vector<Index> up_offsets_;
+    std::vector<Arc> up_arcs_;
+    std::vector<Index> down_offsets_;
+    std::vector<Arc> down_arcs_;
+};
+
+template <typename Weight>
+ContractionHierarchyRouter<Weight>::ContractionHierarchyRouter(const Graph& graph,
+                                                               concurrency::ThreadPool* thread_pool)
+: vertex_count_(graph.GetVertexCount())
+, original_edge_count_(graph.GetEdgeCount())
+{
+    if (vertex_count_ >= NONE || original_edge_count_ >= NONE) {
+        throw std::length_error("Graph is too large for contraction hierarchy");
+    }
+
+    edges_.reserve(original_edge_count_);
+    for (EdgeId edge_id = 0; edge_id < original_edge_count_; ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        // a removed edge keeps its index as a loop, which neither the contraction nor a query takes
+        const Index to = graph.IsEdgeRemoved(edge_id) ? edge.from : edge.to;
+        edges_.push_back({static_cast<Index>(edge.from), to, edge.weight});
+    }
+
+    Contract(thread_pool);
+    BuildSearchGraphs();
+}
+
+template <typename Weight>
+ContractionHierarchyRouter<Weight>::ContractionHierarchyRouter(const Graph& graph, std::istream& input)
+: vertex_count_(graph.GetVertexCount())
+, original_edge_count_(graph.GetEdgeCount())
+{
+    uint64_t vertex_count = 0;
+    uint64_t original_edge_count = 0;
+    uint64_t edge_count = 0;
+    input.read(reinterpret_cast<char*>(&vertex_count), sizeof(vertex_count));
+    input.read(reinterpret_cast<char*>(&original_edge_count), sizeof(original_edge_count));
+    input.read(reinterpret_cast<char*>(&edge_count), sizeof(edge_count));
+    if (!input || vertex_count != vertex_count_ || original_edge_count != original_edge_count_ ||
+        edge_count < original_edge_count || edge_count >= NONE) {
+        throw std::invalid_argument("Contraction hierarchy doesn't match the graph");
+    }
+    // the counts are checked before allocating for them
+    const uint64_t remaining_size = GetRemainingSize(input);
+    if (remaining_size < sizeof(Index) * vertex_count_ ||
+        edge_count > (remaining_size - sizeof(Index) * vertex_count_) / sizeof(HierarchyEdge)) {
+        throw std::invalid_argument("Contraction hierarchy is truncated");
+    }
+
+    ranks_.resize(vertex_count_);
+    edges_.resize(edge_count);
+    input.read(reinterpret_cast<char*>(ranks_.data()), static_cast<std::streamsize>(sizeof(Index) * ranks_.size()));
+    input.read(reinterpret_cast<char*>(edges_.data()),
+               static_cast<std::streamsize>(sizeof(HierarchyEdge) * edges_.size()));
+    if (!input) {
+        throw std::invalid_argument("Contraction hierarchy is truncated");
+    }
+
+    std::vector<bool> is_ranked(vertex_count_, false);
+    for (const Index rank : ranks_) {
+        if (rank >= vertex_count_ || is_ranked[rank]) {
+            throw std::invalid_argument("Contraction hierarchy doesn't match the graph");
+        }
+        is_ranked[rank] = true;
+    }
+    // the original edges come first as the graph has them; a shortcut joins two edges added before it at
+    // a vertex contracted before both its ends and weighs their sum, so unpacking ends in the edges of a walk
+    // of that weight, descending the ranks
+    for (Index edge_index = 0; edge_index < edges_.size(); ++edge_index) {
+        const HierarchyEdge& edge = edges_[edge_index];
+        if (edge.from >= vertex_count_ || edge.to >= vertex_count_) {
+            throw std::invalid_argument("Contraction hierarchy doesn't match the graph");
+        }
+        if (edge_index < original_edge_count_) {
+            const auto& graph_edge = graph.GetEdge(edge_index);
+            const VertexId to = graph.IsEdgeRemoved(edge_index) ? graph_edge.from : graph_edge.to;
+            if (edge.first_half != NONE || edge.second_half != NONE || edge.from != graph_edge.from ||
+                edge.to != to || edge.weight != graph_edge.weight) {
+                throw std::invalid_argument("Contraction hierarchy doesn't match the graph");
+            }
+            continue;
+        }
+        if (edge.first_half >= edge_index || edge.second_half >= edge_index) {
+            throw std::invalid_argument("Contraction hierarchy doesn't match the graph");
+        }
+        const HierarchyEdge& first_half = edges_[edge.first_half];
+        const HierarchyEdge& second_half = edges_[edge.second_half];
+        const Index middle = first_half.to;
+        if (first_half.from != edge.from || second_half.from != middle || second_half.to != edge.to ||
+            ranks_[middle] >= ranks_[edge.from] || ranks_[middle] >= ranks_[edge.to] ||
+            edge.weight != first_half.weight + second_half.weight) {
+            throw std::invalid_argument("Contraction hierarchy doesn't match the graph");
+        }
+    }
+
+    BuildSearchGraphs();
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::Save(std::ostream& output) const {
+    const uint64_t vertex_count = vertex_count_;
+    const uint64_t original_edge_count = original_edge_count_;
+    const uint64_t edge_count = edges_.size();
+    output.write(reinterpret_cast<const char*>(&vertex_count), sizeof(vertex_count));
+    output.write(reinterpret_cast<const char*>(&original_edge_count), sizeof(original_edge_count));
+    output.write(reinterpret_cast<const char*>(&edge_count), sizeof(edge_count));
+    output.write(reinterpret_cast<const char*>(ranks_.data()),
+                 static_cast<std::streamsize>(sizeof(Index) * ranks_.size()));
+    output.write(reinterpret_cast<const char*>(edges_.data()),
+                 static_cast<std::streamsize>(sizeof(HierarchyEdge) * edges_.size()));
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::WitnessSearch::Run(const ContractionHierarchyRouter& router, Index from,
+                                                           Index avoided, Weight max_weight, size_t settled_limit) {
+    for (const Index vertex : touched_) {
+        reached_[vertex] = false;
+    }
+    touched_.clear();
+
+    Queue queue;
+    weights_[from] = ZERO_WEIGHT;
+    reached_[from] = true;
+    touched_.push_back(from);
+    queue.push({ZERO_WEIGHT, from});
+
+    size_t settled_count = 0;
+    size_t settled_target_count = 0;
+    while (!queue.empty() && settled_count < settled_limit && settled_target_count < targets_.size()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (weight > weights_[vertex]) {
+            continue;
+        }
+        if (weight > max_weight) {
+            break;
+        }
+        ++settled_count;
+        if (is_target_[vertex]) {
+            ++settled_target_count;
+        }
+
+        for (const Index edge_index : router.out_edges_[vertex]) {
+            const HierarchyEdge& edge = router.edges_[edge_index];
+            if (edge.to == avoided || router.contracted_[edge.to]) {
+                continue;
+            }
+            const Weight candidate_weight = weight + edge.weight;
+            if (!reached_[edge.to] || candidate_weight < weights_[edge.to]) {
+                if (!reached_[edge.to]) {
+                    reached_[edge.to] = true;
+                    touched_.push_back(edge.to);
+                }
+                weights_[edge.to] = candidate_weight;
+                queue.push({candidate_weight, edge.to});
+            }
+        }
+    }
+}
+
+template <typename Weight>
+std::vector<typename ContractionHierarchyRouter<Weight>::Shortcut>
+ContractionHierarchyRouter<Weight>::FindShortcuts(Index vertex, WitnessSearch& witness_search,
+                                                  size_t settled_limit) const {
+    // the lightest edge from every remaining in-neighbour and to every remaining out-neighbour
+    // the incidence lists are compacted, so every remaining neighbour has a single edge there
+    auto collect_remaining = [this, vertex](const std::vector<Index>& edge_indexes, bool incoming) {
+        std::vector<Index> remaining;
+        for (const Index edge_index : edge_indexes) {
+            const HierarchyEdge& edge = edges_[edge_index];
+            const Index neighbour = incoming ? edge.from : edge.to;
+            if (neighbour != vertex && !contracted_[neighbour]) {
+                remaining.push_back(edge_index);
+            }
+        }
+        return remaining;
+    };
+
+    const std::vector<Index> in_edges = collect_remaining(in_edges_[vertex], true);
+    const std::vector<Index> out_edges = collect_remaining(out_edges_[vertex], false);
+
+    std::vector<Shortcut> shortcuts;
+    if (in_edges.empty() || out_edges.empty()) {
+        return shortcuts;
+    }
+
+    Weight max_out_weight = ZERO_WEIGHT;
+    std::vector<Index> targets;
+    for (const Index out_edge : out_edges) {
+        max_out_weight = std::max(max_out_weight, edges_[out_edge].weight);
+        targets.push_back(edges_[out_edge].to);
+    }
+    witness_search.SetTargets(targets);
+
+    for (const Index in_edge : in_edges) {
+        const HierarchyEdge& first_half = edges_[in_edge];
+        witness_search.Run(*this, first_half.from, vertex, first_half.weight + max_out_weight, settled_limit);
+
+        for (const Index out_edge : out_edges) {
+            const HierarchyEdge& second_half = edges_[out_edge];
+            if (second_half.to == first_half.from) {
+                continue;
+            }
+            const Weight shortcut_weight = first_half.weight + second_half.weight;
+            const std::optional<Weight> witness_weight = witness_search.GetWeight(second_half.to);
+            if (!witness_weight || shortcut_weight < *witness_weight) {
+                shortcuts.push_back({in_edge, out_edge});
+            }
+        }
+    }
+
+    return shortcuts;
+}
+
+template <typename Weight>
+int ContractionHierarchyRouter<Weight>::ComputePriority(Index vertex, WitnessSearch& witness_search) const {
+    int removed_edge_count = 0;
+    for (const Index edge_index : in_edges_[vertex]) {
+        removed_edge_count += contracted_[edges_[edge_index].from] ? 0 : 1;
+    }
+    for (const Index edge_index : out_edges_[vertex]) {
+        removed_edge_count += contracted_[edges_[edge_index].to] ? 0 : 1;
+    }
+
+    const int added_edge_count = static_cast<int>(FindShortcuts(vertex, witness_search, PRIORITY_SETTLED_LIMIT).size());
+
+    // edge difference keeps the hierarchy sparse, contracted neighbours spread contraction over the graph
+    return added_edge_count - removed_edge_count + contracted_neighbours_[vertex];
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::CompactEdges(Index vertex) {
+    auto compact = [this](std::vector<Index>& edge_indexes, auto get_neighbour) {
+        edge_indexes.erase(std::remove_if(edge_indexes.begin(), edge_indexes.end(),
+                                          [&](Index edge_index) { return contracted_[get_neighbour(edge_index)]; }),
+                           edge_indexes.end());
+        std::sort(edge_indexes.begin(), edge_indexes.end(), [&](Index lhs, Index rhs) {
+            return std::pair(get_neighbour(lhs), edges_[lhs].weight) < std::pair(get_neighbour(rhs), edges_[rhs].weight);
+        });
+        edge_indexes.erase(std::unique(edge_indexes.begin(), edge_indexes.end(),
+                                       [&](Index lhs, Index rhs) { return get_neighbour(lhs) == get_neighbour(rhs); }),
+                           edge_indexes.end());
+    };
+
+    compact(out_edges_[vertex], [this](Index edge_index) { return edges_[edge_index].to; });
+    compact(in_edges_[vertex], [this](Index edge_index) { return edges_[edge_index].from; });
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::Contract(concurrency::ThreadPool* thread_pool) {
+    const size_t task_count = thread_pool ? thread_pool->GetThreadCount() : 1;
+    std::vector<WitnessSearch> witness_searches(task_count, WitnessSearch(vertex_count_));
+
+    out_edges_.assign(vertex_count_, {});
+    in_edges_.assign(vertex_count_, {});
+    for (Index edge_index = 0; edge_index < edges_.size(); ++edge_index) {
+        if (edges_[edge_index].from == edges_[edge_index].to) {
+            continue;
+        }
+        out_edges_[edges_[edge_index].from].push_back(edge_index);
+        in_edges_[edges_[edge_index].to].push_back(edge_index);
+    }
+    contracted_.assign(vertex_count_, false);
+    contracted_neighbours_.assign(vertex_count_, 0);
+    ranks_.assign(vertex_count_, NONE);
+    for (Index vertex = 0; vertex < vertex_count_; ++vertex) {
+        CompactEdges(vertex);
+    }
+
+    // runs func(vertex, index, witness_search) for all the vertexes split between the threads
+    auto parallel_for_each = [&](const std::vector<Index>& vertexes, auto func) {
+        concurrency::ParallelFor(thread_pool, 0, task_count, [&](size_t task) {
+            for (size_t i = task; i < vertexes.size(); i += task_count) {
+                func(vertexes[i], i, witness_searches[task]);
+            }
+        });
+    };
+
+    std::vector<int> priorities(vertex_count_);
+    std::vector<Index> remaining(vertex_count_);
+    for (Index vertex = 0; vertex < vertex_count_; ++vertex) {
+        remaining[vertex] = vertex;
+    }
+    parallel_for_each(remaining, [&](Index vertex, size_t, WitnessSearch& witness_search) {
+        priorities[vertex] = ComputePriority(vertex, witness_search);
+    });
+
+    auto is_less_important = [&priorities](Index lhs, Index rhs) {
+        return std::pair(priorities[lhs], lhs) < std::pair(priorities[rhs], rhs);
+    };
+
+    Index next_rank = 0;
+    while (!remaining.empty()) {
+        // vertexes less important than all their remaining neighbours share no edges
+        // and can be contracted at the same time
+        std::vector<Index> independent;
+        for (const Index vertex : remaining) {
+            bool is_local_minimum = true;
+            for (const auto* edge_indexes : {&in_edges_[vertex], &out_edges_[vertex]}) {
+                for (const Index edge_index : *edge_indexes) {
+                    const HierarchyEdge& edge = edges_[edge_index];
+                    const Index neighbour = edge.from == vertex ? edge.to : edge.from;
+                    if (neighbour != vertex && !contracted_[neighbour] && is_less_important(neighbour, vertex)) {
+                        is_local_minimum = false;
+                        break;
+                    }
+                }
+                if (!is_local_minimum) {
+                    break;
+                }
+            }
+            if (is_local_minimum) {
+                independent.push_back(vertex);
+            }
+        }
+
+        // witnesses must avoid the whole batch, otherwise two contracted vertexes
+        // could serve as each other's witness and lose the route between their neighbours
+        for (const Index vertex : independent) {
+            contracted_[vertex] = true;
+            ranks_[vertex] = next_rank++;
+        }
+
+        std::vector<std::vector<Shortcut>> shortcuts(independent.size());
+        parallel_for_each(independent, [&](Index vertex, size_t index, WitnessSearch& witness_search) {
+            shortcuts[index] = FindShortcuts(vertex, witness_search, WITNESS_SETTLED_LIMIT);
+        });
+
+        std::vector<Index> neighbours;
+        for (size_t index = 0; index < independent.size(); ++index) {
+            const Index vertex = independent[index];
+            for (const auto& [first_half, second_half] : shortcuts[index]) {
+                const Index edge_index = static_cast<Index>(edges_.size());
+                if (edge_index == NONE) {
+                    throw std::length_error("Too many shortcuts in contraction hierarchy");
+                }
+                const Index from = edges_[first_half].from;
+                const Index to = edges_[second_half].to;
+                edges_.push_back({from, to, edges_[first_half].weight + edges_[second_half].weight, first_half,
+                                  second_half});
+                out_edges_[from].push_back(edge_index);
+                in_edges_[to].push_back(edge_index);
+            }
+
+            for (const auto* edge_indexes : {&in_edges_[vertex], &out_edges_[vertex]}) {
+                for (const Index edge_index : *edge_indexes) {
+                    const HierarchyEdge& edge = edges_[edge_index];
+                    const Index neighbour = edge.from == vertex ? edge.to : edge.from;
+                    if (!contracted_[neighbour]) {
+                        ++contracted_neighbours_[neighbour];
+                        neighbours.push_back(neighbour);
+                    }
+                }
+            }
+        }
+
+        remaining.erase(std::remove_if(remaining.begin(), remaining.end(),
+                                       [this](Index vertex) { return contracted_[vertex]; }),
+                        remaining.end());
+
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+        for (const Index vertex : neighbours) {
+            CompactEdges(vertex);
+        }
+        parallel_for_each(neighbours, [&](Index vertex, size_t, WitnessSearch& witness_search) {
+            priorities[vertex] = ComputePriority(vertex, witness_search);
+        });
+    }
+
+    out_edges_ = {};
+    in_edges_ = {};
+    contracted_ = {};
+    contracted_neighbours_ = {};
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::BuildSearchGraphs() {
+    up_offsets_.assign(vertex_count_ + 1, 0);
+    down_offsets_.assign(vertex_count_ + 1, 0);
+    for (const HierarchyEdge& edge : edges_) {
+        if (edge.from >= vertex_count_ || edge.to >= vertex_count_) {
+            throw std::invalid_argument("Contraction hierarchy edge is out of range");
+        }
+        if (ranks_[edge.to] > ranks_[edge.from]) {
+            ++up_offsets_[edge.from + 1];
+        } else if (ranks_[edge.from] > ranks_[edge.to]) {
+            ++down_offsets_[edge.to + 1];
+        }
+    }
+    for (size_t vertex = 0; vertex < vertex_count_; ++vertex) {
+        up_offsets_[vertex + 1] += up_offsets_[vertex];
+        down_offsets_[vertex + 1] += down_offsets_[vertex];
+    }
+
+    up_arcs_.resize(up_offsets_.back());
+    down_arcs_.resize(down_offsets_.back());
+    std::vector<Index> up_positions(up_offsets_.begin(), up_offsets_.end() - 1);
+    std::vector<Index> down_positions(down_offsets_.begin(), down_offsets_.end() - 1);
+    for (Index edge_index = 0; edge_index < edges_.size(); ++edge_index) {
+        const HierarchyEdge& edge = edges_[edge_index];
+        if (ranks_[edge.to] > ranks_[edge.from]) {
+            up_arcs_[up_positions[edge.from]++] = {edge.to, edge_index, edge.weight};
+        } else if (ranks_[edge.from] > ranks_[edge.to]) {
+            down_arcs_[down_positions[edge.to]++] = {edge.from, edge_index, edge.weight};
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::UnpackEdge(Index edge, std::vector<EdgeId>& edges) const {
+    std::vector<Index> stack{edge};
+    while (!stack.empty()) {
+        const HierarchyEdge& top = edges_[stack.back()];
+        const Index top_index = stack.back();
+        stack.pop_back();
+        if (top.first_half == NONE) {
+            edges.push_back(top_index);
+        } else {
+            stack.push_back(top.second_half);
+            stack.push_back(top.first_half);
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchyRouter<Weight>::RouteInfo>
+ContractionHierarchyRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    // index 0 searches forward from the start, index 1 backward from the finish, each in its own workspace
+    // of the calling thread; the previous edges are indexes of the hierarchy edges
+    using Workspace = SearchWorkspace<Weight>;
+    Workspace* searches[2] = {&GetThreadSearchWorkspace<Weight>(0), &GetThreadSearchWorkspace<Weight>(1)};
+    const std::vector<Index>* offsets[2] = {&up_offsets_, &down_offsets_};
+    const std::vector<Arc>* arcs[2] = {&up_arcs_, &down_arcs_};
+
+    searches[0]->Reset(vertex_count_);
+    searches[1]->Reset(vertex_count_);
+    searches[0]->Reach(from, ZERO_WEIGHT);
+    searches[1]->Reach(to, ZERO_WEIGHT);
+    searches[0]->Push(ZERO_WEIGHT, from);
+    searches[1]->Push(ZERO_WEIGHT, to);
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = from;
+
+    while (!searches[0]->IsQueueEmpty() || !searches[1]->IsQueueEmpty()) {
+        for (int side = 0; side < 2; ++side) {
+            Workspace& search = *searches[side];
+            const Workspace& opposite = *searches[1 - side];
+            if (search.IsQueueEmpty()) {
+                continue;
+            }
+            const auto [weight, vertex] = search.GetQueueTop();
+            search.Pop();
+            if (weight > search.GetWeight(vertex)) {
+                continue;
+            }
+            // nothing in this queue can improve the best route found so far
+            if (best_weight && !(weight < *best_weight)) {
+                search.ClearQueue();
+                continue;
+            }
+            if (opposite.IsReached(vertex)) {
+                const Weight route_weight = weight + opposite.GetWeight(vertex);
+                if (!best_weight || route_weight < *best_weight) {
+                    best_weight = route_weight;
+                    meeting_vertex = vertex;
+                }
+            }
+
+            for (Index arc = (*offsets[side])[vertex]; arc < (*offsets[side])[vertex + 1]; ++arc) {
+                const Arc& next = (*arcs[side])[arc];
+                const Weight candidate_weight = weight + next.weight;
+                if (!search.IsReached(next.to) || candidate_weight < search.GetWeight(next.to)) {
+                    search.Reach(next.to, candidate_weight, next.edge);
+                    search.Push(candidate_weight, next.to);
+                }
+            }
+        }
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    std::vector<Index> hierarchy_edges;
+    for (EdgeId edge = searches[0]->GetPrevEdge(meeting_vertex); edge != Workspace::NO_EDGE;
+         edge = searches[0]->GetPrevEdge(edges_[edge].from))
+    {
+        hierarchy_edges.push_back(static_cast<Index>(edge));
+    }
+    std::reverse(hierarchy_edges.begin(), hierarchy_edges.end());
+    for (EdgeId edge = searches[1]->GetPrevEdge(meeting_vertex); edge != Workspace::NO_EDGE;
+         edge = searches[1]->GetPrevEdge(edges_[edge].to))
+    {
+        hierarchy_edges.push_back(static_cast<Index>(edge));
+    }
+
+    std::vector<EdgeId> edges;
+    for (const Index edge : hierarchy_edges) {
+        UnpackEdge(edge, edges);
+    }
+
+    return RouteInfo{*best_weight, std::move(edges)};
+}
+
+}  // namespace graph
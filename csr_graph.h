@@ -0,0 +1,94 @@
+#pragma once
+
+#include "graph.h"
+#include "ranges.h"
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace graph {
+
+// frozen copy of a DirectedWeightedGraph in compressed sparse row form: the outgoing (or incoming) arcs
+// of every vertex lie next to each other in one array, so traversals don't chase a separate incidence list
+// per vertex; the accessors don't check bounds
+template <typename Weight>
+class CsrGraph {
+public:
+    enum class Direction {
+        // the arcs of a vertex are its outgoing edges, arc.to is edge.to
+        FORWARD,
+        // the arcs of a vertex are its incoming edges, arc.to is edge.from
+        BACKWARD,
+    };
+
+    struct Arc {
+        uint32_t to;
+        uint32_t edge_id;
+        Weight weight;
+    };
+
+    using ArcsRange = ranges::Range<const Arc*>;
+
+    CsrGraph() = default;
+    explicit CsrGraph(const DirectedWeightedGraph<Weight>& graph, Direction direction = Direction::FORWARD);
+
+    size_t GetVertexCount() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+
+    size_t GetArcCount() const { return arcs_.size(); }
+
+    ArcsRange GetArcs(VertexId vertex) const {
+        return ArcsRange{arcs_.data() + offsets_[vertex], arcs_.data() + offsets_[vertex + 1]};
+    }
+
+private:
+    std::vector<uint32_t> offsets_;
+    std::vector<Arc> arcs_;
+};
+
+template <typename Weight>
+CsrGraph<Weight>::CsrGraph(const DirectedWeightedGraph<Weight>& graph, Direction direction) {
+    const size_t vertex_count = graph.GetVertexCount();
+    const size_t edge_count = graph.GetEdgeCount();
+    if (vertex_count >= std::numeric_limits<uint32_t>::max() || edge_count >= std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Graph is too large for CSR form");
+    }
+
+    if (direction == Direction::FORWARD) {
+        offsets_.reserve(vertex_count + 1);
+        arcs_.reserve(edge_count);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            offsets_.push_back(static_cast<uint32_t>(arcs_.size()));
+            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+                const auto& edge = graph.GetEdge(edge_id);
+                arcs_.push_back({static_cast<uint32_t>(edge.to), static_cast<uint32_t>(edge_id), edge.weight});
+            }
+        }
+        offsets_.push_back(static_cast<uint32_t>(arcs_.size()));
+        return;
+    }
+
+    // counting sort of the edges by their heads, keeps the edge id order inside every vertex
+    offsets_.assign(vertex_count + 1, 0);
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (!graph.IsEdgeRemoved(edge_id)) {
+            ++offsets_[graph.GetEdge(edge_id).to + 1];
+        }
+    }
+    for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        offsets_[vertex + 1] += offsets_[vertex];
+    }
+    std::vector<uint32_t> positions(offsets_.begin(), offsets_.end() - 1);
+    arcs_.resize(offsets_.back());
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (graph.IsEdgeRemoved(edge_id)) {
+            continue;
+        }
+        const auto& edge = graph.GetEdge(edge_id);
+        arcs_[positions[edge.to]++] = {static_cast<uint32_t>(edge.from), static_cast<uint32_t>(edge_id),
+                                       edge.weight};
+    }
+}
+
+}  // namespace graph
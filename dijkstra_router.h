@@ -0,0 +1,145 @@
+#pragma once
+
+#include "csr_graph.h"
+#include "graph.h"
+#include "router.h"
+#include "search_workspace.h"
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// answers every query with its own Dijkstra search: O(E) construction and memory,
+// O(E log V) per query; a query to many targets grows one search tree for all of them.
+// Queries search in the workspace of the calling thread, so they run concurrently without locks
+// and without allocating scratch memory
+template <typename Weight>
+class DijkstraRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+
+    explicit DijkstraRouter(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from,
+                                                      const std::vector<VertexId>& targets) const override;
+
+private:
+    using Workspace = SearchWorkspace<Weight>;
+
+    // searches from the start until all the targets are settled, the workspace keeps the search tree
+    void GrowSearchTree(Workspace& workspace, VertexId from, const std::vector<VertexId>& targets) const;
+
+    std::optional<RouteInfo> ExtractRoute(const Workspace& workspace, VertexId to) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    CsrGraph<Weight> csr_graph_;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph)
+: graph_(graph)
+, csr_graph_(graph)
+{
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(VertexId from,
+                                                                                             VertexId to) const {
+    Workspace& workspace = GetThreadSearchWorkspace<Weight>();
+    GrowSearchTree(workspace, from, {to});
+    return ExtractRoute(workspace, to);
+}
+
+template <typename Weight>
+std::vector<std::optional<typename DijkstraRouter<Weight>::RouteInfo>> DijkstraRouter<Weight>::BuildRoutes(
+    VertexId from, const std::vector<VertexId>& targets) const {
+    Workspace& workspace = GetThreadSearchWorkspace<Weight>();
+    GrowSearchTree(workspace, from, targets);
+
+    std::vector<std::optional<RouteInfo>> routes;
+    routes.reserve(targets.size());
+    for (const VertexId to : targets) {
+        routes.push_back(ExtractRoute(workspace, to));
+    }
+    return routes;
+}
+
+template <typename Weight>
+void DijkstraRouter<Weight>::GrowSearchTree(Workspace& workspace, VertexId from,
+                                            const std::vector<VertexId>& targets) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    workspace.Reset(vertex_count);
+    size_t unsettled_target_count = 0;
+    for (const VertexId to : targets) {
+        if (to >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        if (!workspace.IsMarked(to)) {
+            workspace.Mark(to);
+            ++unsettled_target_count;
+        }
+    }
+
+    workspace.Reach(from, ZERO_WEIGHT);
+    workspace.Push(ZERO_WEIGHT, from);
+
+    while (!workspace.IsQueueEmpty()) {
+        const auto [weight, vertex] = workspace.GetQueueTop();
+        workspace.Pop();
+        if (workspace.IsSettled(vertex)) {
+            continue;
+        }
+        workspace.Settle(vertex);
+        if (workspace.IsMarked(vertex) && --unsettled_target_count == 0) {
+            break;
+        }
+
+        for (const auto& arc : csr_graph_.GetArcs(vertex)) {
+            const Weight candidate_weight = weight + arc.weight;
+            if (!workspace.IsReached(arc.to) || candidate_weight < workspace.GetWeight(arc.to)) {
+                workspace.Reach(arc.to, candidate_weight, arc.edge_id);
+                workspace.Push(candidate_weight, arc.to);
+            }
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::ExtractRoute(
+    const Workspace& workspace, VertexId to) const {
+    if (!workspace.IsReached(to)) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = workspace.GetPrevEdge(to);
+         edge_id != Workspace::NO_EDGE;
+         edge_id = workspace.GetPrevEdge(graph_.GetEdge(edge_id).from))
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{workspace.GetWeight(to), std::move(edges)};
+}
+
+}  // namespace graph
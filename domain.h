@@ -1,5 +1,6 @@
 #pragma once
 
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -16,6 +17,8 @@ using BusPtr = const Bus*;
 struct Stop {
     std::string name;
     geo::Coordinates coordinates;
+    // dense index of the stop in the catalogue, assigned by TransportCatalogue::AddStop
+    size_t id{};
 };
 
 struct Bus {
@@ -31,7 +34,7 @@ struct BusPointerComparator {
 struct DistanceBetweenStopsHash {
     size_t operator()(const std::pair<StopPtr, StopPtr>& pair_of_stops) const {
         size_t from_hashed = poiner_hasher_(pair_of_stops.first);
-        size_t to_hashed = poiner_hasher_(pair_of_stops.first);
+        size_t to_hashed = poiner_hasher_(pair_of_stops.second);
 
         // 37 is a random prime number
         return 37 * from_hashed + to_hashed;
@@ -49,4 +52,29 @@ struct RoutingSettings {
 struct RouteInfo {
     std::string_view from;
     std::string_view to;
+    static constexpr int MAX_ALTERNATIVES = 10;
+
+    // the number of alternative routes to answer after the best one, up to MAX_ALTERNATIVES
+    int alternatives = 0;
+    // how many minutes longer than the best route an alternative may be
+    double max_time_gap = 30.0;
+    // answer every route no other route beats both in time and in the number of boardings,
+    // instead of the best route and never along with alternatives
+    bool pareto = false;
+    // how many times a Pareto route may board
+    int max_boardings = std::numeric_limits<int>::max();
+};
+
+struct RouteMatrixInfo {
+    std::vector<std::string_view> from;
+    std::vector<std::string_view> to;
+    // answer the itineraries along with the total times
+    bool with_items = false;
+};
+
+struct IsochroneInfo {
+    std::string_view stop;
+    double max_time = 0.0;
+    // the stops that reach the stop instead of the stops it reaches
+    bool is_reverse = false;
 };
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// answers every query with a Dijkstra search over a copy of the graph whose weights are rounded to whole
+// numbers of a unit: the search compares integers and keeps its queue in a radix heap. A route is weighed
+// back in the original weights along its edges, so it weighs exactly what it would from any other engine,
+// but among routes closer than the rounding of their edges the search may pick another one
+template <typename Weight>
+class FixedPointRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+    using FixedPoint = uint64_t;
+
+    // unit is the weight of one fixed-point step, the graph must outlive the router
+    FixedPointRouter(const Graph& graph, Weight unit);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from,
+                                                      const std::vector<VertexId>& targets) const override;
+
+private:
+    using FixedPointRouteInfo = typename RouterBase<FixedPoint>::RouteInfo;
+
+    // the same edges under the same ids, no route of distinct vertexes overflows the sum of its weights
+    static DirectedWeightedGraph<FixedPoint> ConvertGraph(const Graph& graph, Weight unit);
+
+    std::optional<RouteInfo> WeighRoute(std::optional<FixedPointRouteInfo> route) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    DirectedWeightedGraph<FixedPoint> fixed_point_graph_;
+    DijkstraRouter<FixedPoint> router_;
+};
+
+template <typename Weight>
+FixedPointRouter<Weight>::FixedPointRouter(const Graph& graph, Weight unit)
+: graph_(graph)
+, fixed_point_graph_(ConvertGraph(graph, unit))
+, router_(fixed_point_graph_)
+{
+}
+
+template <typename Weight>
+std::optional<typename FixedPointRouter<Weight>::RouteInfo> FixedPointRouter<Weight>::BuildRoute(VertexId from,
+                                                                                                 VertexId to) const {
+    return WeighRoute(router_.BuildRoute(from, to));
+}
+
+template <typename Weight>
+std::vector<std::optional<typename FixedPointRouter<Weight>::RouteInfo>> FixedPointRouter<Weight>::BuildRoutes(
+    VertexId from, const std::vector<VertexId>& targets) const {
+    std::vector<std::optional<FixedPointRouteInfo>> fixed_point_routes = router_.BuildRoutes(from, targets);
+
+    std::vector<std::optional<RouteInfo>> routes;
+    routes.reserve(fixed_point_routes.size());
+    for (auto& route : fixed_point_routes) {
+        routes.push_back(WeighRoute(std::move(route)));
+    }
+    return routes;
+}
+
+template <typename Weight>
+DirectedWeightedGraph<typename FixedPointRouter<Weight>::FixedPoint> FixedPointRouter<Weight>::ConvertGraph(
+    const Graph& graph, Weight unit) {
+    if (!(ZERO_WEIGHT < unit)) {
+        throw std::domain_error("Fixed-point unit should be positive");
+    }
+
+    const double max_steps = static_cast<double>(std::numeric_limits<FixedPoint>::max() /
+                                                 std::max<size_t>(graph.GetVertexCount(), 1));
+
+    DirectedWeightedGraph<FixedPoint> fixed_point_graph(graph.GetVertexCount());
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        const Edge<Weight>& edge = graph.GetEdge(edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        const double steps = std::round(static_cast<double>(edge.weight / unit));
+        if (!(steps < max_steps)) {
+            throw std::out_of_range("Edge weight doesn't fit the fixed point");
+        }
+        fixed_point_graph.AddEdge({edge.from, edge.to, static_cast<FixedPoint>(steps)});
+        if (graph.IsEdgeRemoved(edge_id)) {
+            fixed_point_graph.RemoveEdge(edge_id);
+        }
+    }
+    return fixed_point_graph;
+}
+
+template <typename Weight>
+std::optional<typename FixedPointRouter<Weight>::RouteInfo> FixedPointRouter<Weight>::WeighRoute(
+    std::optional<FixedPointRouteInfo> route) const {
+    if (!route) {
+        return std::nullopt;
+    }
+
+    // summed from the start like the searches do
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : route->edges) {
+        weight += graph_.GetEdge(edge_id).weight;
+    }
+    return RouteInfo{weight, std::move(route->edges)};
+}
+
+}  // namespace graph
@@ -2,6 +2,7 @@
 
 #include "ranges.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <vector>
 
@@ -27,6 +28,12 @@ public:
     DirectedWeightedGraph() = default;
     explicit DirectedWeightedGraph(size_t vertex_count);
     EdgeId AddEdge(const Edge<Weight>& edge);
+
+    // a removed edge keeps its id and data, so the ids of the other edges stay valid, but it leaves
+    // the incident edges of its tail and no route takes it
+    void RemoveEdge(EdgeId edge_id);
+    bool IsEdgeRemoved(EdgeId edge_id) const;
+    void SetEdgeWeight(EdgeId edge_id, Weight weight);
     
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
@@ -36,6 +43,7 @@ public:
 private:
     std::vector<Edge<Weight>> edges_;
     std::vector<IncidenceList> incidence_lists_;
+    std::vector<bool> removed_edges_;
 };
 
 template <typename Weight>
@@ -48,9 +56,30 @@ EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
     edges_.push_back(edge);
     const EdgeId id = edges_.size() - 1;
     incidence_lists_.at(edge.from).push_back(id);
+    removed_edges_.push_back(false);
     return id;
 }
 
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::RemoveEdge(EdgeId edge_id) {
+    if (removed_edges_.at(edge_id)) {
+        return;
+    }
+    IncidenceList& incidence_list = incidence_lists_[edges_[edge_id].from];
+    incidence_list.erase(std::find(incidence_list.begin(), incidence_list.end(), edge_id));
+    removed_edges_[edge_id] = true;
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsEdgeRemoved(EdgeId edge_id) const {
+    return removed_edges_.at(edge_id);
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::SetEdgeWeight(EdgeId edge_id, Weight weight) {
+    edges_.at(edge_id).weight = weight;
+}
+
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
     return incidence_lists_.size();
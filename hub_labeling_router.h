@@ -0,0 +1,417 @@
+#pragma once
+
+#include "csr_graph.h"
+#include "graph.h"
+#include "router.h"
+#include "search_workspace.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// pruned landmark labels of every vertex, a query merges the out label of one end with the in label
+// of the other without searching
+template <typename Weight>
+class HubLabelingRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+
+    explicit HubLabelingRouter(const Graph& graph);
+
+    // loads the labels written by Save for the same graph
+    HubLabelingRouter(const Graph& graph, std::istream& input);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    void Save(std::ostream& output) const;
+
+    size_t GetLabelEntryCount() const { return hubs_[OUT].size() + hubs_[IN].size(); }
+
+private:
+    using Index = uint32_t;
+
+    static constexpr Index NONE = std::numeric_limits<Index>::max();
+    static constexpr Weight ZERO_WEIGHT{};
+
+    static constexpr size_t OUT = 0;
+    static constexpr size_t IN = 1;
+
+    // the hub is the rank of its vertex, the parent edge leads from the vertex towards the hub in an out label
+    // and from the hub's side into the vertex in an in label, NONE in the labels of the hub itself
+    struct LabelEntry {
+        Index hub;
+        Index parent_edge;
+        Weight weight;
+    };
+
+    using Labels = std::vector<std::vector<LabelEntry>>;
+
+    // vertexes joined to many others go first, so that they cover the most routes and prune the later searches
+    void OrderVertexes(const CsrGraph<Weight>& forward_graph, const CsrGraph<Weight>& backward_graph);
+
+    // the search from a hub along (or against) the edges, it adds the hub to the in (or out) labels
+    // of the vertexes it settles; hub_label is the opposite label of the hub itself
+    void GrowLabels(const CsrGraph<Weight>& csr_graph, Index hub, const std::vector<LabelEntry>& hub_label,
+                    Labels& labels, std::vector<std::optional<Weight>>& hub_weights) const;
+
+    // the entry of the hub in a label of the vertex, which lies on the route the entry was made along,
+    // NONE if the label has none
+    Index FindEntry(size_t side, VertexId vertex, Index hub) const;
+
+    // whether the parent edge of every entry of the side leads from its vertex to the entry of the same hub
+    // whose weight is less by the edge's, and so on to the entry of the hub itself, so BuildRoute ends
+    bool AreParentsRooted(size_t side) const;
+
+    size_t vertex_count_;
+    size_t edge_count_;
+    const Graph& graph_;
+
+    // the vertex of every rank
+    std::vector<Index> vertexes_;
+
+    // the out and in labels of every vertex in CSR form, the entries of a label in the order of their hubs
+    std::array<std::vector<Index>, 2> offsets_;
+    std::array<std::vector<Index>, 2> hubs_;
+    std::array<std::vector<Index>, 2> parent_edges_;
+    std::array<std::vector<Weight>, 2> weights_;
+};
+
+template <typename Weight>
+HubLabelingRouter<Weight>::HubLabelingRouter(const Graph& graph)
+: vertex_count_(graph.GetVertexCount())
+, edge_count_(graph.GetEdgeCount())
+, graph_(graph)
+{
+    if (vertex_count_ >= NONE || edge_count_ >= NONE) {
+        throw std::length_error("Graph is too large for hub labeling");
+    }
+    for (EdgeId edge_id = 0; edge_id < edge_count_; ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+
+    const CsrGraph<Weight> forward_graph(graph, CsrGraph<Weight>::Direction::FORWARD);
+    const CsrGraph<Weight> backward_graph(graph, CsrGraph<Weight>::Direction::BACKWARD);
+    OrderVertexes(forward_graph, backward_graph);
+
+    // the hubs come in the order of their ranks, so every label grows sorted
+    std::array<Labels, 2> labels{Labels(vertex_count_), Labels(vertex_count_)};
+    std::vector<std::optional<Weight>> hub_weights(vertex_count_);
+    for (Index hub = 0; hub < vertex_count_; ++hub) {
+        GrowLabels(forward_graph, hub, labels[OUT][vertexes_[hub]], labels[IN], hub_weights);
+        GrowLabels(backward_graph, hub, labels[IN][vertexes_[hub]], labels[OUT], hub_weights);
+    }
+
+    for (const size_t side : {OUT, IN}) {
+        offsets_[side].reserve(vertex_count_ + 1);
+        for (const auto& label : labels[side]) {
+            offsets_[side].push_back(static_cast<Index>(hubs_[side].size()));
+            for (const LabelEntry& entry : label) {
+                hubs_[side].push_back(entry.hub);
+                parent_edges_[side].push_back(entry.parent_edge);
+                weights_[side].push_back(entry.weight);
+            }
+        }
+        offsets_[side].push_back(static_cast<Index>(hubs_[side].size()));
+    }
+}
+
+template <typename Weight>
+HubLabelingRouter<Weight>::HubLabelingRouter(const Graph& graph, std::istream& input)
+: vertex_count_(graph.GetVertexCount())
+, edge_count_(graph.GetEdgeCount())
+, graph_(graph)
+{
+    uint64_t vertex_count = 0;
+    uint64_t edge_count = 0;
+    std::array<uint64_t, 2> entry_counts{};
+    input.read(reinterpret_cast<char*>(&vertex_count), sizeof(vertex_count));
+    input.read(reinterpret_cast<char*>(&edge_count), sizeof(edge_count));
+    input.read(reinterpret_cast<char*>(entry_counts.data()), sizeof(entry_counts));
+    if (!input || vertex_count != vertex_count_ || edge_count != edge_count_) {
+        throw std::invalid_argument("Hub labels don't match the graph");
+    }
+    // a hub, a parent edge and a weight per entry, the counts are checked before allocating for them
+    const uint64_t entry_size = 2 * sizeof(Index) + sizeof(Weight);
+    const uint64_t offsets_size = sizeof(Index) * (3 * vertex_count_ + 2);
+    const uint64_t remaining_size = GetRemainingSize(input);
+    if (remaining_size < offsets_size || entry_counts[OUT] >= NONE || entry_counts[IN] >= NONE ||
+        (entry_counts[OUT] + entry_counts[IN]) > (remaining_size - offsets_size) / entry_size) {
+        throw std::invalid_argument("Hub labels are truncated");
+    }
+
+    vertexes_.resize(vertex_count_);
+    input.read(reinterpret_cast<char*>(vertexes_.data()),
+               static_cast<std::streamsize>(sizeof(Index) * vertexes_.size()));
+    for (const size_t side : {OUT, IN}) {
+        offsets_[side].resize(vertex_count_ + 1);
+        hubs_[side].resize(entry_counts[side]);
+        parent_edges_[side].resize(entry_counts[side]);
+        weights_[side].resize(entry_counts[side]);
+        input.read(reinterpret_cast<char*>(offsets_[side].data()),
+                   static_cast<std::streamsize>(sizeof(Index) * offsets_[side].size()));
+        input.read(reinterpret_cast<char*>(hubs_[side].data()),
+                   static_cast<std::streamsize>(sizeof(Index) * hubs_[side].size()));
+        input.read(reinterpret_cast<char*>(parent_edges_[side].data()),
+                   static_cast<std::streamsize>(sizeof(Index) * parent_edges_[side].size()));
+        input.read(reinterpret_cast<char*>(weights_[side].data()),
+                   static_cast<std::streamsize>(sizeof(Weight) * weights_[side].size()));
+    }
+    if (!input || offsets_[OUT].back() != entry_counts[OUT] || offsets_[IN].back() != entry_counts[IN]) {
+        throw std::invalid_argument("Hub labels are truncated");
+    }
+
+    // the queries index by the ranks, the hubs and the edges as they are, and merge the labels by their hubs
+    std::vector<bool> is_ranked(vertex_count_, false);
+    for (const Index vertex : vertexes_) {
+        if (vertex >= vertex_count_ || is_ranked[vertex]) {
+            throw std::invalid_argument("Hub labels don't match the graph");
+        }
+        is_ranked[vertex] = true;
+    }
+    for (const size_t side : {OUT, IN}) {
+        if (offsets_[side].front() != 0) {
+            throw std::invalid_argument("Hub labels don't match the graph");
+        }
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            if (offsets_[side][vertex] > offsets_[side][vertex + 1]) {
+                throw std::invalid_argument("Hub labels don't match the graph");
+            }
+            for (Index index = offsets_[side][vertex]; index < offsets_[side][vertex + 1]; ++index) {
+                if (hubs_[side][index] >= vertex_count_ ||
+                    (index > offsets_[side][vertex] && hubs_[side][index - 1] >= hubs_[side][index]) ||
+                    (parent_edges_[side][index] != NONE && parent_edges_[side][index] >= edge_count_)) {
+                    throw std::invalid_argument("Hub labels don't match the graph");
+                }
+            }
+        }
+        if (!AreParentsRooted(side)) {
+            throw std::invalid_argument("Hub labels don't match the graph");
+        }
+    }
+}
+
+template <typename Weight>
+void HubLabelingRouter<Weight>::Save(std::ostream& output) const {
+    const uint64_t vertex_count = vertex_count_;
+    const uint64_t edge_count = edge_count_;
+    const std::array<uint64_t, 2> entry_counts{hubs_[OUT].size(), hubs_[IN].size()};
+    output.write(reinterpret_cast<const char*>(&vertex_count), sizeof(vertex_count));
+    output.write(reinterpret_cast<const char*>(&edge_count), sizeof(edge_count));
+    output.write(reinterpret_cast<const char*>(entry_counts.data()), sizeof(entry_counts));
+    output.write(reinterpret_cast<const char*>(vertexes_.data()),
+                 static_cast<std::streamsize>(sizeof(Index) * vertexes_.size()));
+    for (const size_t side : {OUT, IN}) {
+        output.write(reinterpret_cast<const char*>(offsets_[side].data()),
+                     static_cast<std::streamsize>(sizeof(Index) * offsets_[side].size()));
+        output.write(reinterpret_cast<const char*>(hubs_[side].data()),
+                     static_cast<std::streamsize>(sizeof(Index) * hubs_[side].size()));
+        output.write(reinterpret_cast<const char*>(parent_edges_[side].data()),
+                     static_cast<std::streamsize>(sizeof(Index) * parent_edges_[side].size()));
+        output.write(reinterpret_cast<const char*>(weights_[side].data()),
+                     static_cast<std::streamsize>(sizeof(Weight) * weights_[side].size()));
+    }
+}
+
+template <typename Weight>
+std::optional<typename HubLabelingRouter<Weight>::RouteInfo> HubLabelingRouter<Weight>::BuildRoute(VertexId from,
+                                                                                                   VertexId to) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (from == to) {
+        return RouteInfo{ZERO_WEIGHT, {}};
+    }
+
+    // the common hub with the lightest route through it, of equal ones the most important
+    std::optional<Weight> best_weight;
+    Index best_hub = NONE;
+    Index out_index = offsets_[OUT][from];
+    Index in_index = offsets_[IN][to];
+    const Index out_end = offsets_[OUT][from + 1];
+    const Index in_end = offsets_[IN][to + 1];
+    while (out_index < out_end && in_index < in_end) {
+        const Index out_hub = hubs_[OUT][out_index];
+        const Index in_hub = hubs_[IN][in_index];
+        if (out_hub < in_hub) {
+            ++out_index;
+        } else if (in_hub < out_hub) {
+            ++in_index;
+        } else {
+            const Weight weight = weights_[OUT][out_index] + weights_[IN][in_index];
+            if (!best_weight || weight < *best_weight) {
+                best_weight = weight;
+                best_hub = out_hub;
+            }
+            ++out_index;
+            ++in_index;
+        }
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    // every vertex on the way to the hub got its entry from the search tree of the hub, so the parent edges
+    // lead from entry to entry; the in half is unwound from the finish back to the hub
+    std::vector<EdgeId> edges;
+    for (VertexId vertex = from; vertex != vertexes_[best_hub];) {
+        const Index edge_id = parent_edges_[OUT][FindEntry(OUT, vertex, best_hub)];
+        edges.push_back(edge_id);
+        vertex = graph_.GetEdge(edge_id).to;
+    }
+    const size_t out_half_size = edges.size();
+    for (VertexId vertex = to; vertex != vertexes_[best_hub];) {
+        const Index edge_id = parent_edges_[IN][FindEntry(IN, vertex, best_hub)];
+        edges.push_back(edge_id);
+        vertex = graph_.GetEdge(edge_id).from;
+    }
+    std::reverse(edges.begin() + static_cast<std::ptrdiff_t>(out_half_size), edges.end());
+
+    // summed along the route like the searches do, not as the two halves of the labels
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : edges) {
+        weight += graph_.GetEdge(edge_id).weight;
+    }
+    return RouteInfo{weight, std::move(edges)};
+}
+
+template <typename Weight>
+void HubLabelingRouter<Weight>::OrderVertexes(const CsrGraph<Weight>& forward_graph,
+                                              const CsrGraph<Weight>& backward_graph) {
+    std::vector<size_t> degrees(vertex_count_);
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        for (const CsrGraph<Weight>* csr_graph : {&forward_graph, &backward_graph}) {
+            const auto arcs = csr_graph->GetArcs(vertex);
+            degrees[vertex] += static_cast<size_t>(arcs.end() - arcs.begin());
+        }
+    }
+
+    vertexes_.resize(vertex_count_);
+    std::iota(vertexes_.begin(), vertexes_.end(), Index{0});
+    std::stable_sort(vertexes_.begin(), vertexes_.end(), [&degrees](Index lhs, Index rhs) {
+        return degrees[lhs] > degrees[rhs];
+    });
+}
+
+template <typename Weight>
+void HubLabelingRouter<Weight>::GrowLabels(const CsrGraph<Weight>& csr_graph, Index hub,
+                                           const std::vector<LabelEntry>& hub_label, Labels& labels,
+                                           std::vector<std::optional<Weight>>& hub_weights) const {
+    // the weights between the hub and the earlier hubs, to check the labels of a settled vertex against
+    for (const LabelEntry& entry : hub_label) {
+        hub_weights[entry.hub] = entry.weight;
+    }
+
+    SearchWorkspace<Weight>& workspace = GetThreadSearchWorkspace<Weight>();
+    workspace.Reset(vertex_count_);
+    workspace.Reach(vertexes_[hub], ZERO_WEIGHT);
+    workspace.Push(ZERO_WEIGHT, vertexes_[hub]);
+
+    while (!workspace.IsQueueEmpty()) {
+        const auto [weight, vertex] = workspace.GetQueueTop();
+        workspace.Pop();
+        if (workspace.IsSettled(vertex)) {
+            continue;
+        }
+        workspace.Settle(vertex);
+
+        std::vector<LabelEntry>& label = labels[vertex];
+        const bool is_covered = std::any_of(label.begin(), label.end(), [&](const LabelEntry& entry) {
+            return hub_weights[entry.hub] && !(weight < *hub_weights[entry.hub] + entry.weight);
+        });
+        if (is_covered) {
+            continue;
+        }
+        const EdgeId prev_edge = workspace.GetPrevEdge(vertex);
+        label.push_back({hub, prev_edge == SearchWorkspace<Weight>::NO_EDGE ? NONE : static_cast<Index>(prev_edge),
+                         weight});
+
+        for (const auto& arc : csr_graph.GetArcs(vertex)) {
+            const Weight candidate_weight = weight + arc.weight;
+            if (!workspace.IsReached(arc.to) || candidate_weight < workspace.GetWeight(arc.to)) {
+                workspace.Reach(arc.to, candidate_weight, arc.edge_id);
+                workspace.Push(candidate_weight, arc.to);
+            }
+        }
+    }
+
+    for (const LabelEntry& entry : hub_label) {
+        hub_weights[entry.hub].reset();
+    }
+}
+
+template <typename Weight>
+typename HubLabelingRouter<Weight>::Index HubLabelingRouter<Weight>::FindEntry(size_t side, VertexId vertex,
+                                                                             Index hub) const {
+    const auto begin = hubs_[side].begin() + offsets_[side][vertex];
+    const auto end = hubs_[side].begin() + offsets_[side][vertex + 1];
+    const auto it = std::lower_bound(begin, end, hub);
+    return it != end && *it == hub ? static_cast<Index>(it - hubs_[side].begin()) : NONE;
+}
+
+template <typename Weight>
+bool HubLabelingRouter<Weight>::AreParentsRooted(size_t side) const {
+    enum : uint8_t { UNSEEN, ON_PATH, ROOTED };
+
+    std::vector<uint8_t> states(hubs_[side].size(), UNSEEN);
+    std::vector<Index> path;
+    for (VertexId vertex_from = 0; vertex_from < vertex_count_; ++vertex_from) {
+        for (Index index_from = offsets_[side][vertex_from]; index_from < offsets_[side][vertex_from + 1];
+             ++index_from) {
+            const Index hub = hubs_[side][index_from];
+            VertexId vertex = vertex_from;
+            Index index = index_from;
+            while (states[index] == UNSEEN) {
+                const Index edge_id = parent_edges_[side][index];
+                if (vertex == vertexes_[hub]) {
+                    if (edge_id != NONE || weights_[side][index] != ZERO_WEIGHT) {
+                        return false;
+                    }
+                    states[index] = ROOTED;
+                    break;
+                }
+                if (edge_id == NONE || graph_.IsEdgeRemoved(edge_id)) {
+                    return false;
+                }
+                const auto& edge = graph_.GetEdge(edge_id);
+                if ((side == OUT ? edge.from : edge.to) != vertex) {
+                    return false;
+                }
+                vertex = side == OUT ? edge.to : edge.from;
+                const Index next_index = FindEntry(side, vertex, hub);
+                // the labels are built by adding the edge's weight to the next entry's, so the sums match exactly
+                if (next_index == NONE || weights_[side][index] != weights_[side][next_index] + edge.weight) {
+                    return false;
+                }
+                states[index] = ON_PATH;
+                path.push_back(index);
+                index = next_index;
+            }
+            if (states[index] == ON_PATH) {
+                return false;
+            }
+            for (const Index path_index : path) {
+                states[path_index] = ROOTED;
+            }
+            path.clear();
+        }
+    }
+    return true;
+}
+
+}  // namespace graph
@@ -22,6 +22,10 @@ void JsonReader::ReadJson(std::istream& input_stream) {
     if (parsed_json_document.GetRoot().AsDict().count("routing_settings"s)) {
         routing_settings_ = parsed_json_document.GetRoot().AsDict().at("routing_settings"s).AsDict();
     }
+
+    if (parsed_json_document.GetRoot().AsDict().count("serialization_settings"s)) {
+        serialization_settings_ = parsed_json_document.GetRoot().AsDict().at("serialization_settings"s).AsDict();
+    }
 }
 
 svg::Color ColorFromNodeArray(const json::Node& node) {
@@ -150,7 +154,7 @@ json::Array json_reader::HandleRequests(const json::Array& requests_json,
         std::string_view type = request.AsDict().at("type"s).AsString();
 
         std::optional<std::string_view> name;
-        if (type != "Map"sv && type != "Route"sv) {
+        if (type != "Map"sv && type != "Route"sv && type != "RouteMatrix"sv && type != "Isochrone"sv) {
             name = request.AsDict().at("name"s).AsString();
         }
 
@@ -159,12 +163,50 @@ json::Array json_reader::HandleRequests(const json::Array& requests_json,
             RouteInfo info;
             info.to = request.AsDict().at("to"s).AsString();
             info.from = request.AsDict().at("from"s).AsString();
+            if (request.AsDict().count("alternatives"s)) {
+                info.alternatives = request.AsDict().at("alternatives"s).AsInt();
+            }
+            if (request.AsDict().count("max_time_gap"s)) {
+                info.max_time_gap = request.AsDict().at("max_time_gap"s).AsDouble();
+            }
+            if (request.AsDict().count("pareto"s)) {
+                info.pareto = request.AsDict().at("pareto"s).AsBool();
+            }
+            if (request.AsDict().count("max_boardings"s)) {
+                info.max_boardings = request.AsDict().at("max_boardings"s).AsInt();
+            }
             route_info = info;
         }
 
+        std::optional<RouteMatrixInfo> route_matrix_info;
+        if (type == "RouteMatrix"sv) {
+            RouteMatrixInfo info;
+            for (const json::Node& stop_name : request.AsDict().at("from"s).AsArray()) {
+                info.from.push_back(stop_name.AsString());
+            }
+            for (const json::Node& stop_name : request.AsDict().at("to"s).AsArray()) {
+                info.to.push_back(stop_name.AsString());
+            }
+            if (request.AsDict().count("itineraries"s)) {
+                info.with_items = request.AsDict().at("itineraries"s).AsBool();
+            }
+            route_matrix_info = std::move(info);
+        }
+
+        // "from" asks for the stops reachable from the stop, "to" for the stops it is reachable from
+        std::optional<IsochroneInfo> isochrone_info;
+        if (type == "Isochrone"sv) {
+            IsochroneInfo info;
+            info.is_reverse = request.AsDict().count("from"s) == 0;
+            info.stop = request.AsDict().at(info.is_reverse ? "to"s : "from"s).AsString();
+            info.max_time = request.AsDict().at("max_time"s).AsDouble();
+            isochrone_info = info;
+        }
+
         int id = json::GetIntValue(request, "id"s);
 
-        output.push_back(handler.GetResponseToStatRequest(type, id, name, route_info));
+        output.push_back(
+            handler.GetResponseToStatRequest(type, id, name, route_info, route_matrix_info, isochrone_info));
     }
 
     return output;
@@ -2,7 +2,11 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <variant>
 
@@ -51,6 +55,58 @@ inline RoutingSettings BuildRoutingSettings(const json::Node& node) {
     return routing_settings;
 }
 
+// "engine" of the routing settings takes the names of router::ParseRoutingEngine, "memory_budget_mb" and
+// "build_time_budget" in seconds bound the "auto" engine, "thread_count" is 0 for all hardware threads;
+// "fixed_point_dijkstra" may print totals off by a hundredth, so neither the default nor "auto" picks it
+inline router::RouterOptions BuildRouterOptions(const json::Dict& routing_settings,
+                                                const json::Dict& serialization_settings) {
+    router::RouterOptions options;
+
+    if (routing_settings.count("engine"s)) {
+        const std::string& name = routing_settings.at("engine"s).AsString();
+        const std::optional<router::RoutingEngine> engine = router::ParseRoutingEngine(name);
+        if (!engine) {
+            throw std::invalid_argument("unknown routing engine "s + name);
+        }
+        options.engine = *engine;
+    }
+    if (routing_settings.count("memory_budget_mb"s)) {
+        const double memory_budget_mb = routing_settings.at("memory_budget_mb"s).AsDouble();
+        if (!(memory_budget_mb >= 0.0) || !std::isfinite(memory_budget_mb)) {
+            throw std::invalid_argument("memory_budget_mb should be non-negative"s);
+        }
+        // a budget past the address space bounds nothing
+        const double memory_budget = memory_budget_mb * (1 << 20);
+        options.memory_budget = memory_budget < static_cast<double>(std::numeric_limits<size_t>::max())
+                                    ? static_cast<size_t>(memory_budget)
+                                    : std::numeric_limits<size_t>::max();
+    }
+    if (routing_settings.count("build_time_budget"s)) {
+        options.build_time_budget = routing_settings.at("build_time_budget"s).AsDouble();
+        if (!(options.build_time_budget >= 0.0)) {
+            throw std::invalid_argument("build_time_budget should be non-negative"s);
+        }
+    }
+    if (routing_settings.count("thread_count"s)) {
+        const int thread_count = routing_settings.at("thread_count"s).AsInt();
+        if (thread_count < 0) {
+            throw std::invalid_argument("thread_count should be non-negative"s);
+        }
+        options.thread_count = static_cast<size_t>(thread_count);
+    }
+    if (serialization_settings.count("file"s)) {
+        options.cache_file = serialization_settings.at("file"s).AsString();
+    }
+
+    return options;
+}
+
+// "wait_for_router" of the routing settings, true by default: whether the route requests wait for the router
+// built in the background or are answered with the "router warming" error until it is built
+inline bool IsWaitingForRouter(const json::Dict& routing_settings) {
+    return !routing_settings.count("wait_for_router"s) || routing_settings.at("wait_for_router"s).AsBool();
+}
+
 class JsonReader {
 public:
     void ReadJson(std::istream& input_stream);
@@ -63,8 +119,11 @@ public:
 
     const json::Dict& GetRoutingSettings() const { return routing_settings_; }
 
+    const json::Dict& GetSerializationSettings() const { return serialization_settings_; }
+
 private:
     json::Dict routing_settings_;
+    json::Dict serialization_settings_;
     json::Dict render_settings_;
     json::Array base_requests_;
     json::Array stat_requests_;
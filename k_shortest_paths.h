@@ -0,0 +1,276 @@
+#pragma once
+
+#include "csr_graph.h"
+#include "graph.h"
+#include "router.h"
+#include "search_workspace.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// finds the k lightest loopless routes between two vertexes with Yen's algorithm: every next route leaves one
+// of the routes found so far at some vertex, its spur, and avoids the edges the found routes take there.
+// One backward search from the finish is shared by all the spur searches: it gives the first route and exact
+// remaining weights in the whole graph, which the spur searches use as an A* bound; every spur search runs
+// in the workspace of the thread it runs on
+template <typename Weight>
+class KShortestPaths {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouterBase<Weight>::RouteInfo;
+
+    // the CSR graphs are the graph along and against its edges, all of them must outlive the search
+    KShortestPaths(const Graph& graph, const CsrGraph<Weight>& forward_graph,
+                   const CsrGraph<Weight>& backward_graph);
+
+    // up to route_count routes in the order of their weights, none heavier than the lightest one
+    // by more than max_weight_gap; the spur searches of every step run on the thread pool
+    std::vector<RouteInfo> FindRoutes(VertexId from, VertexId to, size_t route_count, Weight max_weight_gap,
+                                      concurrency::ThreadPool& thread_pool) const;
+
+private:
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    // remaining weights to the finish and the first edges of the lightest routes there, filled for the vertexes
+    // whose remaining weight is within the budget
+    struct FinishTree {
+        std::vector<std::optional<Weight>> weights;
+        std::vector<std::optional<EdgeId>> next_edges;
+    };
+
+    FinishTree GrowFinishTree(VertexId from, VertexId to, Weight max_weight_gap) const;
+
+    // the lightest route from the spur to the finish that avoids the blocked vertexes and edges
+    // and doesn't exceed max_weight
+    std::optional<RouteInfo> FindSpurRoute(VertexId spur, VertexId to, const FinishTree& finish_tree,
+                                           const std::vector<bool>& blocked_vertexes,
+                                           const std::vector<EdgeId>& blocked_edges, Weight max_weight) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    const CsrGraph<Weight>& forward_graph_;
+    const CsrGraph<Weight>& backward_graph_;
+};
+
+template <typename Weight>
+KShortestPaths<Weight>::KShortestPaths(const Graph& graph, const CsrGraph<Weight>& forward_graph,
+                                       const CsrGraph<Weight>& backward_graph)
+: graph_(graph)
+, forward_graph_(forward_graph)
+, backward_graph_(backward_graph)
+{
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+std::vector<typename KShortestPaths<Weight>::RouteInfo> KShortestPaths<Weight>::FindRoutes(
+    VertexId from, VertexId to, size_t route_count, Weight max_weight_gap,
+    concurrency::ThreadPool& thread_pool) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    std::vector<RouteInfo> routes;
+    if (route_count == 0) {
+        return routes;
+    }
+
+    const FinishTree finish_tree = GrowFinishTree(from, to, max_weight_gap);
+    if (!finish_tree.weights[from]) {
+        return routes;
+    }
+
+    const Weight max_weight = *finish_tree.weights[from] + max_weight_gap;
+
+    RouteInfo first_route{ZERO_WEIGHT, {}};
+    for (VertexId vertex = from; vertex != to; vertex = graph_.GetEdge(first_route.edges.back()).to) {
+        first_route.edges.push_back(*finish_tree.next_edges[vertex]);
+        first_route.weight += graph_.GetEdge(first_route.edges.back()).weight;
+    }
+    routes.push_back(std::move(first_route));
+
+    std::vector<RouteInfo> candidates;
+    while (routes.size() < route_count) {
+        const RouteInfo& last_route = routes.back();
+
+        // the vertexes of the last route and the weights of its prefixes
+        std::vector<VertexId> vertexes{from};
+        std::vector<Weight> root_weights{ZERO_WEIGHT};
+        for (const EdgeId edge_id : last_route.edges) {
+            vertexes.push_back(graph_.GetEdge(edge_id).to);
+            root_weights.push_back(root_weights.back() + graph_.GetEdge(edge_id).weight);
+        }
+
+        // every vertex of the last route but the finish is a spur, the routes are loopless
+        // because the spur routes avoid the vertexes of their roots
+        std::vector<std::optional<RouteInfo>> spur_candidates(last_route.edges.size());
+        thread_pool.ParallelFor(0, last_route.edges.size(), [&](size_t spur_index) {
+            const auto root_begin = last_route.edges.begin();
+            const auto root_end = root_begin + static_cast<std::ptrdiff_t>(spur_index);
+
+            std::vector<EdgeId> blocked_edges;
+            for (const RouteInfo& route : routes) {
+                if (route.edges.size() > spur_index && std::equal(root_begin, root_end, route.edges.begin())) {
+                    blocked_edges.push_back(route.edges[spur_index]);
+                }
+            }
+            std::vector<bool> blocked_vertexes(vertex_count, false);
+            for (size_t index = 0; index < spur_index; ++index) {
+                blocked_vertexes[vertexes[index]] = true;
+            }
+
+            std::optional<RouteInfo> spur_route =
+                FindSpurRoute(vertexes[spur_index], to, finish_tree, blocked_vertexes, blocked_edges,
+                              max_weight - root_weights[spur_index]);
+            if (!spur_route) {
+                return;
+            }
+
+            RouteInfo candidate{root_weights[spur_index] + spur_route->weight, {root_begin, root_end}};
+            candidate.edges.insert(candidate.edges.end(), spur_route->edges.begin(), spur_route->edges.end());
+            spur_candidates[spur_index] = std::move(candidate);
+        });
+
+        for (auto& candidate : spur_candidates) {
+            const auto is_same_route = [&candidate](const RouteInfo& route) {
+                return route.edges == candidate->edges;
+            };
+            if (candidate && std::none_of(candidates.begin(), candidates.end(), is_same_route)) {
+                candidates.push_back(std::move(*candidate));
+            }
+        }
+        if (candidates.empty()) {
+            break;
+        }
+
+        // the lightest candidate is the next route, the first found of equal ones
+        const auto lightest = std::min_element(candidates.begin(), candidates.end(),
+                                               [](const RouteInfo& lhs, const RouteInfo& rhs) {
+                                                   return lhs.weight < rhs.weight;
+                                               });
+        routes.push_back(std::move(*lightest));
+        candidates.erase(lightest);
+    }
+
+    return routes;
+}
+
+template <typename Weight>
+typename KShortestPaths<Weight>::FinishTree KShortestPaths<Weight>::GrowFinishTree(VertexId from, VertexId to,
+                                                                                 Weight max_weight_gap) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+
+    FinishTree finish_tree{std::vector<std::optional<Weight>>(vertex_count),
+                           std::vector<std::optional<EdgeId>>(vertex_count)};
+    std::vector<std::optional<Weight>> weights(vertex_count);
+    // known once the start is settled
+    std::optional<Weight> max_weight;
+
+    Queue queue;
+    weights[to] = ZERO_WEIGHT;
+    queue.push({ZERO_WEIGHT, to});
+
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (finish_tree.weights[vertex]) {
+            continue;
+        }
+        if (max_weight && *max_weight < weight) {
+            break;
+        }
+        // a settled weight is final, the others stay unknown and those vertexes are out of the budget
+        finish_tree.weights[vertex] = weight;
+        if (vertex == from) {
+            max_weight = weight + max_weight_gap;
+        }
+
+        for (const auto& arc : backward_graph_.GetArcs(vertex)) {
+            const Weight candidate_weight = weight + arc.weight;
+            if (!weights[arc.to] || candidate_weight < *weights[arc.to]) {
+                weights[arc.to] = candidate_weight;
+                finish_tree.next_edges[arc.to] = arc.edge_id;
+                queue.push({candidate_weight, arc.to});
+            }
+        }
+    }
+
+    return finish_tree;
+}
+
+template <typename Weight>
+std::optional<typename KShortestPaths<Weight>::RouteInfo> KShortestPaths<Weight>::FindSpurRoute(
+    VertexId spur, VertexId to, const FinishTree& finish_tree, const std::vector<bool>& blocked_vertexes,
+    const std::vector<EdgeId>& blocked_edges, Weight max_weight) const {
+    using Workspace = SearchWorkspace<Weight>;
+    Workspace& workspace = GetThreadSearchWorkspace<Weight>();
+    workspace.Reset(graph_.GetVertexCount());
+
+    // the remaining weight in the whole graph bounds the one that avoids the blocked part,
+    // a vertex without it can't reach the finish within the budget
+    workspace.Reach(spur, ZERO_WEIGHT);
+    workspace.Push(*finish_tree.weights[spur], spur);
+
+    while (!workspace.IsQueueEmpty()) {
+        const VertexId vertex = workspace.GetQueueTop().second;
+        workspace.Pop();
+        if (workspace.IsSettled(vertex)) {
+            continue;
+        }
+        workspace.Settle(vertex);
+        if (vertex == to) {
+            break;
+        }
+
+        const Weight weight = workspace.GetWeight(vertex);
+        for (const auto& arc : forward_graph_.GetArcs(vertex)) {
+            if (blocked_vertexes[arc.to] || workspace.IsSettled(arc.to) || !finish_tree.weights[arc.to] ||
+                std::find(blocked_edges.begin(), blocked_edges.end(), arc.edge_id) != blocked_edges.end()) {
+                continue;
+            }
+            const Weight candidate_weight = weight + arc.weight;
+            const Weight candidate_bound = candidate_weight + *finish_tree.weights[arc.to];
+            if (max_weight < candidate_bound) {
+                continue;
+            }
+            if (!workspace.IsReached(arc.to) || candidate_weight < workspace.GetWeight(arc.to)) {
+                workspace.Reach(arc.to, candidate_weight, arc.edge_id);
+                workspace.Push(candidate_bound, arc.to);
+            }
+        }
+    }
+
+    if (!workspace.IsSettled(to)) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = workspace.GetPrevEdge(to);
+         edge_id != Workspace::NO_EDGE;
+         edge_id = workspace.GetPrevEdge(graph_.GetEdge(edge_id).from))
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{workspace.GetWeight(to), std::move(edges)};
+}
+
+}  // namespace graph
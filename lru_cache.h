@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace concurrency {
+
+struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+};
+
+// a bounded cache that drops the least recently used entries, split into shards by the hash of the key,
+// each with its own mutex and its own share of the capacity
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+    // a capacity of 0 keeps nothing, shard_count should be positive
+    explicit LruCache(size_t capacity, size_t shard_count = 16);
+
+    LruCache(const LruCache&) = delete;
+    LruCache& operator=(const LruCache&) = delete;
+
+    // a copy of the cached value, which becomes the most recently used one; the copy is made under the lock
+    // of the shard, so values should be cheap to copy
+    std::optional<Value> Get(const Key& key);
+
+    // replaces the value of a key cached already
+    void Put(const Key& key, Value value);
+
+    // drops every entry, the counters go on
+    void Clear();
+
+    CacheStats GetStats() const;
+
+private:
+    using Entries = std::list<std::pair<Key, Value>>;
+
+    struct Shard {
+        size_t capacity = 0;
+        std::mutex mutex;
+        // the most recently used entries first
+        Entries entries;
+        std::unordered_map<Key, typename Entries::iterator, Hash> positions;
+    };
+
+    // the hash is mixed first: std::hash leaves pointers as they are, and aligned ones share their low bits
+    Shard& GetShard(const Key& key) {
+        const uint64_t mixed_hash = static_cast<uint64_t>(hash_(key)) * 0x9E3779B97F4A7C15ull;
+        return shards_[(mixed_hash >> 32) % shards_.size()];
+    }
+
+    Hash hash_;
+    std::vector<Shard> shards_;
+    std::atomic<size_t> hits_{0};
+    std::atomic<size_t> misses_{0};
+};
+
+template <typename Key, typename Value, typename Hash>
+LruCache<Key, Value, Hash>::LruCache(size_t capacity, size_t shard_count)
+: shards_(shard_count)
+{
+    if (shard_count == 0) {
+        throw std::invalid_argument("Cache should have at least one shard");
+    }
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_[i].capacity = capacity / shard_count + (i < capacity % shard_count ? 1 : 0);
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+std::optional<Value> LruCache<Key, Value, Hash>::Get(const Key& key) {
+    Shard& shard = GetShard(key);
+    std::lock_guard lock(shard.mutex);
+
+    const auto it = shard.positions.find(key);
+    if (it == shard.positions.end()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    return it->second->second;
+}
+
+template <typename Key, typename Value, typename Hash>
+void LruCache<Key, Value, Hash>::Put(const Key& key, Value value) {
+    Shard& shard = GetShard(key);
+    if (shard.capacity == 0) {
+        return;
+    }
+    std::lock_guard lock(shard.mutex);
+
+    if (const auto it = shard.positions.find(key); it != shard.positions.end()) {
+        it->second->second = std::move(value);
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        return;
+    }
+    if (shard.entries.size() == shard.capacity) {
+        shard.positions.erase(shard.entries.back().first);
+        shard.entries.pop_back();
+    }
+    shard.entries.emplace_front(key, std::move(value));
+    shard.positions.emplace(key, shard.entries.begin());
+}
+
+template <typename Key, typename Value, typename Hash>
+void LruCache<Key, Value, Hash>::Clear() {
+    for (Shard& shard : shards_) {
+        std::lock_guard lock(shard.mutex);
+        shard.entries.clear();
+        shard.positions.clear();
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+CacheStats LruCache<Key, Value, Hash>::GetStats() const {
+    return {hits_.load(std::memory_order_relaxed), misses_.load(std::memory_order_relaxed)};
+}
+
+}  // namespace concurrency
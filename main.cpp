@@ -1,4 +1,6 @@
+#include <future>
 #include <iostream>
+#include <memory>
 #include <sstream>
 
 #include "json.h"
@@ -25,9 +27,17 @@ int main() {
     renderer::MapRenderer map_renderer(transport_catalogue,
                                        json_reader::ReadRenderSettings(json_reader.GetRenderSettings()));
 
-    router::TransportRouter router(transport_catalogue, BuildRoutingSettings(json_reader.GetRoutingSettings()));
-
-    RequestHandler request_handler{transport_catalogue, map_renderer, router};
+    // the router is built in the background while the requests that don't route are answered; the catalogue
+    // is only read from here on
+    std::shared_future<std::unique_ptr<router::TransportRouter>> router =
+        std::async(std::launch::async, [&transport_catalogue, &json_reader] {
+            return std::make_unique<router::TransportRouter>(
+                transport_catalogue, BuildRoutingSettings(json_reader.GetRoutingSettings()),
+                BuildRouterOptions(json_reader.GetRoutingSettings(), json_reader.GetSerializationSettings()));
+        }).share();
+
+    RequestHandler request_handler{transport_catalogue, map_renderer, router,
+                                   IsWaitingForRouter(json_reader.GetRoutingSettings())};
 
     auto response = json_reader::HandleRequests(json_reader.GetStatRequests(), request_handler);
 
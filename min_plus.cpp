@@ -0,0 +1,140 @@
+#include "min_plus.h"
+
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MIN_PLUS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace graph {
+
+namespace min_plus {
+
+namespace {
+
+constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+template <typename Weight>
+void RelaxRowFallback(Weight weight_from, uint32_t prev_edge_from, const Weight* weights_through,
+                      const uint32_t* prev_edges_through, Weight* weights, uint32_t* prev_edges, size_t count) {
+    RelaxRowScalar(weight_from, prev_edge_from, weights_through, prev_edges_through, weights, prev_edges, count,
+                   std::numeric_limits<Weight>::infinity(), NO_EDGE);
+}
+
+#ifdef MIN_PLUS_AVX2
+
+// an infinite candidate never compares less, so unreachable cells need no separate check
+__attribute__((target("avx2"))) void RelaxRowAvx2(double weight_from, uint32_t prev_edge_from,
+                                                  const double* weights_through,
+                                                  const uint32_t* prev_edges_through, double* weights,
+                                                  uint32_t* prev_edges, size_t count) {
+    const __m256d from = _mm256_set1_pd(weight_from);
+    const __m128i edge_from = _mm_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m128i no_edge = _mm_set1_epi32(static_cast<int>(NO_EDGE));
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256d current = _mm256_loadu_pd(weights + i);
+        const __m256d candidate = _mm256_add_pd(from, _mm256_loadu_pd(weights_through + i));
+        const __m256d relaxed = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+        if (_mm256_movemask_pd(relaxed) == 0) {
+            continue;
+        }
+        _mm256_storeu_pd(weights + i, _mm256_blendv_pd(current, candidate, relaxed));
+
+        // narrow the four 64-bit lane masks to 32-bit ones to blend the edges
+        const __m128 relaxed_low = _mm256_castps256_ps128(_mm256_castpd_ps(relaxed));
+        const __m128 relaxed_high = _mm256_extractf128_ps(_mm256_castpd_ps(relaxed), 1);
+        const __m128i relaxed_edges =
+            _mm_castps_si128(_mm_shuffle_ps(relaxed_low, relaxed_high, _MM_SHUFFLE(2, 0, 2, 0)));
+
+        const __m128i edges_through = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_through + i));
+        const __m128i new_edges =
+            _mm_blendv_epi8(edges_through, edge_from, _mm_cmpeq_epi32(edges_through, no_edge));
+        const __m128i current_edges = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(prev_edges + i),
+                         _mm_blendv_epi8(current_edges, new_edges, relaxed_edges));
+    }
+
+    RelaxRowFallback(weight_from, prev_edge_from, weights_through + i, prev_edges_through + i, weights + i,
+                     prev_edges + i, count - i);
+}
+
+__attribute__((target("avx2"))) void RelaxRowAvx2(float weight_from, uint32_t prev_edge_from,
+                                                  const float* weights_through, const uint32_t* prev_edges_through,
+                                                  float* weights, uint32_t* prev_edges, size_t count) {
+    const __m256 from = _mm256_set1_ps(weight_from);
+    const __m256i edge_from = _mm256_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m256i no_edge = _mm256_set1_epi32(static_cast<int>(NO_EDGE));
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 current = _mm256_loadu_ps(weights + i);
+        const __m256 candidate = _mm256_add_ps(from, _mm256_loadu_ps(weights_through + i));
+        const __m256 relaxed = _mm256_cmp_ps(candidate, current, _CMP_LT_OQ);
+        if (_mm256_movemask_ps(relaxed) == 0) {
+            continue;
+        }
+        _mm256_storeu_ps(weights + i, _mm256_blendv_ps(current, candidate, relaxed));
+
+        const __m256i edges_through =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_edges_through + i));
+        const __m256i new_edges =
+            _mm256_blendv_epi8(edges_through, edge_from, _mm256_cmpeq_epi32(edges_through, no_edge));
+        const __m256i current_edges = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_edges + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(prev_edges + i),
+                            _mm256_blendv_epi8(current_edges, new_edges, _mm256_castps_si256(relaxed)));
+    }
+
+    RelaxRowFallback(weight_from, prev_edge_from, weights_through + i, prev_edges_through + i, weights + i,
+                     prev_edges + i, count - i);
+}
+
+#endif
+
+bool DetectSimdSupport() {
+#ifdef MIN_PLUS_AVX2
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+template <typename Weight>
+using RelaxRowFunction = void (*)(Weight, uint32_t, const Weight*, const uint32_t*, Weight*, uint32_t*, size_t);
+
+// the kernel is chosen once, on the first call
+template <typename Weight>
+RelaxRowFunction<Weight> ChooseRelaxRow() {
+#ifdef MIN_PLUS_AVX2
+    if (HasSimdSupport()) {
+        return RelaxRowAvx2;
+    }
+#endif
+    return RelaxRowFallback<Weight>;
+}
+
+}  // namespace
+
+bool HasSimdSupport() {
+    static const bool has_simd_support = DetectSimdSupport();
+    return has_simd_support;
+}
+
+void RelaxRow(double weight_from, uint32_t prev_edge_from, const double* weights_through,
+              const uint32_t* prev_edges_through, double* weights, uint32_t* prev_edges, size_t count) {
+    static const RelaxRowFunction<double> relax_row = ChooseRelaxRow<double>();
+    relax_row(weight_from, prev_edge_from, weights_through, prev_edges_through, weights, prev_edges, count);
+}
+
+void RelaxRow(float weight_from, uint32_t prev_edge_from, const float* weights_through,
+              const uint32_t* prev_edges_through, float* weights, uint32_t* prev_edges, size_t count) {
+    static const RelaxRowFunction<float> relax_row = ChooseRelaxRow<float>();
+    relax_row(weight_from, prev_edge_from, weights_through, prev_edges_through, weights, prev_edges, count);
+}
+
+}  // namespace min_plus
+
+}  // namespace graph
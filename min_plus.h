@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace graph {
+
+namespace min_plus {
+
+// relaxes a row of routes through one vertex:
+// weights[i] = min(weights[i], weight_from + weights_through[i]), and a relaxed cell takes
+// prev_edges_through[i], or prev_edge_from when the route through the vertex ends at the vertex itself;
+// unreachable cells hold infinite_weight, routes without edges hold no_edge
+template <typename Weight, typename EdgeIndex>
+void RelaxRowScalar(Weight weight_from, EdgeIndex prev_edge_from, const Weight* weights_through,
+                    const EdgeIndex* prev_edges_through, Weight* weights, EdgeIndex* prev_edges, size_t count,
+                    Weight infinite_weight, EdgeIndex no_edge) {
+    for (size_t i = 0; i < count; ++i) {
+        if (weights_through[i] == infinite_weight) {
+            continue;
+        }
+        const Weight candidate_weight = weight_from + weights_through[i];
+        if (candidate_weight < weights[i]) {
+            weights[i] = candidate_weight;
+            prev_edges[i] = prev_edges_through[i] != no_edge ? prev_edges_through[i] : prev_edge_from;
+        }
+    }
+}
+
+// the same for IEEE weights with +infinity for unreachable cells and 0xFFFFFFFF for missing edges,
+// uses AVX2 (4 doubles or 8 floats per instruction) when the CPU supports it
+void RelaxRow(double weight_from, uint32_t prev_edge_from, const double* weights_through,
+              const uint32_t* prev_edges_through, double* weights, uint32_t* prev_edges, size_t count);
+
+void RelaxRow(float weight_from, uint32_t prev_edge_from, const float* weights_through,
+              const uint32_t* prev_edges_through, float* weights, uint32_t* prev_edges, size_t count);
+
+bool HasSimdSupport();
+
+}  // namespace min_plus
+
+}  // namespace graph
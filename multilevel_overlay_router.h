@@ -0,0 +1,621 @@
+#pragma once
+
+#include "csr_graph.h"
+#include "graph.h"
+#include "router.h"
+#include "search_workspace.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// customizable route planning: cliques between the boundary vertexes of the cells of a multilevel partition,
+// a query passes the cells away from its ends by their cliques
+template <typename Weight>
+class MultilevelOverlayRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+
+    // customizes on the pool, which must outlive the router, or on the calling thread; the levels are added
+    // while a level has more than level_factor cells
+    explicit MultilevelOverlayRouter(const Graph& graph, concurrency::ThreadPool* thread_pool = nullptr,
+                                     size_t cell_size = 128, size_t level_factor = 8);
+
+    // loads the partition written by Save for a graph of the same vertexes and customizes it
+    MultilevelOverlayRouter(const Graph& graph, std::istream& input,
+                            concurrency::ThreadPool* thread_pool = nullptr);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    // customizes the cliques to the edges anew and keeps the partition, unless the vertexes changed
+    bool UpdateEdges(const std::vector<EdgeId>& edge_ids) override;
+
+    // the partition only, the cliques depend on the weights
+    void Save(std::ostream& output) const;
+
+    size_t GetLevelCount() const { return cells_.size(); }
+
+    size_t GetCliqueArcCount() const;
+
+private:
+    using Index = uint32_t;
+    using Workspace = SearchWorkspace<Weight>;
+
+    static constexpr Index NONE = std::numeric_limits<Index>::max();
+    static constexpr Weight ZERO_WEIGHT{};
+
+    struct OverlayArc {
+        Index from;
+        Index to;
+        Weight weight;
+        // NONE for a clique arc
+        Index edge_id;
+    };
+
+    // the clique arcs of a level and the edges between its cells leaving every vertex, so a search at the level
+    // doesn't pass the edges inside the cells
+    struct Overlay {
+        std::vector<Index> offsets;
+        std::vector<OverlayArc> arcs;
+        // the id of the first arc in the searches, after the edges and the arcs of the levels below
+        EdgeId first_arc_id = 0;
+    };
+
+    // groups the units joined by the adjacency into cells of at most max_size close units, returns the cell
+    // of every unit
+    static std::vector<Index> GrowCells(const std::vector<std::vector<Index>>& adjacency, size_t max_size);
+
+    void Partition(size_t cell_size, size_t level_factor);
+
+    // builds the search graph and the cliques of every level from the current edges
+    void Customize();
+
+    void CustomizeLevel(size_t level);
+
+    // the level a query passes the vertex on: the highest one whose cell of the vertex holds neither end
+    size_t GetQueryLevel(VertexId vertex, VertexId from, VertexId to) const;
+
+    // calls visit(to, weight, arc id) for the overlay arcs of the vertex at the level, for every edge at level 0
+    template <typename Visit>
+    void ForEachArc(VertexId vertex, size_t level, Visit visit) const;
+
+    // a Dijkstra search from the vertex over the arcs of a level that stay in its cell of the next level,
+    // stops when the target is settled
+    void SearchCell(Workspace& workspace, VertexId from, size_t arc_level, VertexId target) const;
+
+    // the level of a clique arc of the searches, 0 for an edge
+    size_t GetArcLevel(EdgeId arc_id) const;
+
+    const OverlayArc& GetCliqueArc(size_t level, EdgeId arc_id) const {
+        return overlays_[level - 1].arcs[arc_id - overlays_[level - 1].first_arc_id];
+    }
+
+    VertexId GetArcFrom(EdgeId arc_id) const {
+        const size_t level = GetArcLevel(arc_id);
+        return level == 0 ? graph_.GetEdge(arc_id).from : GetCliqueArc(level, arc_id).from;
+    }
+
+    // the arcs a search came to the vertex by, in the order of the route
+    std::vector<EdgeId> GetSearchArcs(const Workspace& workspace, VertexId from, VertexId to) const;
+
+    // appends the edges of an arc of the searches, a clique arc is searched for inside its cell over the arcs
+    // of the level below and they are unpacked in turn
+    void UnpackArc(EdgeId arc_id, std::vector<EdgeId>& edges) const;
+
+    const Graph& graph_;
+    concurrency::ThreadPool* thread_pool_;
+    CsrGraph<Weight> csr_graph_;
+    EdgeId edge_count_ = 0;
+    // the cell of every vertex at every level from 1 on
+    std::vector<std::vector<Index>> cells_;
+    std::vector<Index> cell_counts_;
+    // the cliques of every level from 1 on
+    std::vector<Overlay> overlays_;
+};
+
+template <typename Weight>
+MultilevelOverlayRouter<Weight>::MultilevelOverlayRouter(const Graph& graph, concurrency::ThreadPool* thread_pool,
+                                                         size_t cell_size, size_t level_factor)
+: graph_(graph)
+, thread_pool_(thread_pool)
+, csr_graph_(graph)
+{
+    if (cell_size < 2 || level_factor < 2) {
+        throw std::invalid_argument("Cells should hold at least two vertexes or cells");
+    }
+    Partition(cell_size, level_factor);
+    Customize();
+}
+
+template <typename Weight>
+MultilevelOverlayRouter<Weight>::MultilevelOverlayRouter(const Graph& graph, std::istream& input,
+                                                         concurrency::ThreadPool* thread_pool)
+: graph_(graph)
+, thread_pool_(thread_pool)
+, csr_graph_(graph)
+{
+    uint64_t vertex_count = 0;
+    uint64_t level_count = 0;
+    input.read(reinterpret_cast<char*>(&vertex_count), sizeof(vertex_count));
+    input.read(reinterpret_cast<char*>(&level_count), sizeof(level_count));
+    // every level has fewer cells than the one below
+    if (!input || vertex_count != graph.GetVertexCount() || vertex_count >= NONE || level_count > vertex_count) {
+        throw std::invalid_argument("Partition doesn't match the graph");
+    }
+    // the counts are checked before allocating for them: a cell count and the cells of every vertex per level
+    const uint64_t remaining_size = GetRemainingSize(input);
+    if (level_count > remaining_size / (sizeof(Index) * (vertex_count + 1))) {
+        throw std::invalid_argument("Partition is truncated");
+    }
+
+    cells_.resize(level_count);
+    cell_counts_.resize(level_count);
+    input.read(reinterpret_cast<char*>(cell_counts_.data()),
+               static_cast<std::streamsize>(sizeof(Index) * cell_counts_.size()));
+    if (!input) {
+        throw std::invalid_argument("Partition is truncated");
+    }
+    // the boundaries and cliques are sized by the cell counts, so a level has no empty cells and no more cells
+    // than the level below or the vertexes
+    for (size_t level = 0; level < level_count; ++level) {
+        const uint64_t max_cell_count = level == 0 ? vertex_count : cell_counts_[level - 1] - uint64_t{1};
+        if ((vertex_count > 0 && cell_counts_[level] == 0) || cell_counts_[level] > max_cell_count) {
+            throw std::invalid_argument("Partition doesn't match the graph");
+        }
+    }
+
+    for (size_t level = 0; level < level_count; ++level) {
+        cells_[level].resize(vertex_count);
+        input.read(reinterpret_cast<char*>(cells_[level].data()),
+                   static_cast<std::streamsize>(sizeof(Index) * cells_[level].size()));
+        if (!input) {
+            throw std::invalid_argument("Partition is truncated");
+        }
+        // the cells of a level nest in the cells of the next one, the searches in a cell stay in the cell above
+        std::vector<Index> upper_cells(level == 0 ? 0 : cell_counts_[level - 1], NONE);
+        std::vector<bool> is_filled(cell_counts_[level], false);
+        size_t filled_count = 0;
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            const Index cell = cells_[level][vertex];
+            if (cell >= cell_counts_[level]) {
+                throw std::invalid_argument("Partition doesn't match the graph");
+            }
+            if (!is_filled[cell]) {
+                is_filled[cell] = true;
+                ++filled_count;
+            }
+            if (level > 0) {
+                Index& upper_cell = upper_cells[cells_[level - 1][vertex]];
+                if (upper_cell != NONE && upper_cell != cell) {
+                    throw std::invalid_argument("Partition doesn't match the graph");
+                }
+                upper_cell = cell;
+            }
+        }
+        if (filled_count != cell_counts_[level]) {
+            throw std::invalid_argument("Partition doesn't match the graph");
+        }
+    }
+    Customize();
+}
+
+template <typename Weight>
+std::optional<typename MultilevelOverlayRouter<Weight>::RouteInfo> MultilevelOverlayRouter<Weight>::BuildRoute(
+    VertexId from, VertexId to) const {
+    const size_t vertex_count = csr_graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    Workspace& workspace = GetThreadSearchWorkspace<Weight>();
+    workspace.Reset(vertex_count);
+    workspace.Reach(from, ZERO_WEIGHT);
+    workspace.Push(ZERO_WEIGHT, from);
+    while (!workspace.IsQueueEmpty()) {
+        const auto [weight, vertex] = workspace.GetQueueTop();
+        workspace.Pop();
+        if (workspace.IsSettled(vertex)) {
+            continue;
+        }
+        workspace.Settle(vertex);
+        if (vertex == to) {
+            break;
+        }
+
+        ForEachArc(vertex, GetQueryLevel(vertex, from, to), [&workspace, weight = weight](VertexId arc_to,
+                                                                                          Weight arc_weight,
+                                                                                          EdgeId arc_id) {
+            const Weight new_weight = weight + arc_weight;
+            if (!workspace.IsReached(arc_to) || new_weight < workspace.GetWeight(arc_to)) {
+                workspace.Reach(arc_to, new_weight, arc_id);
+                workspace.Push(new_weight, arc_to);
+            }
+        });
+    }
+    if (!workspace.IsReached(to)) {
+        return std::nullopt;
+    }
+
+    // summed from the start like the searches do
+    std::vector<EdgeId> edges;
+    for (const EdgeId arc_id : GetSearchArcs(workspace, from, to)) {
+        UnpackArc(arc_id, edges);
+    }
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : edges) {
+        weight += graph_.GetEdge(edge_id).weight;
+    }
+    return RouteInfo{weight, std::move(edges)};
+}
+
+template <typename Weight>
+bool MultilevelOverlayRouter<Weight>::UpdateEdges(const std::vector<EdgeId>& /*edge_ids*/) {
+    if (graph_.GetVertexCount() != csr_graph_.GetVertexCount()) {
+        return false;
+    }
+    csr_graph_ = CsrGraph<Weight>(graph_);
+    Customize();
+    return true;
+}
+
+template <typename Weight>
+void MultilevelOverlayRouter<Weight>::Save(std::ostream& output) const {
+    const uint64_t vertex_count = csr_graph_.GetVertexCount();
+    const uint64_t level_count = cells_.size();
+    output.write(reinterpret_cast<const char*>(&vertex_count), sizeof(vertex_count));
+    output.write(reinterpret_cast<const char*>(&level_count), sizeof(level_count));
+    output.write(reinterpret_cast<const char*>(cell_counts_.data()),
+                 static_cast<std::streamsize>(sizeof(Index) * cell_counts_.size()));
+    for (const auto& cells : cells_) {
+        output.write(reinterpret_cast<const char*>(cells.data()),
+                     static_cast<std::streamsize>(sizeof(Index) * cells.size()));
+    }
+}
+
+template <typename Weight>
+size_t MultilevelOverlayRouter<Weight>::GetCliqueArcCount() const {
+    size_t arc_count = 0;
+    for (const Overlay& overlay : overlays_) {
+        arc_count += std::count_if(overlay.arcs.begin(), overlay.arcs.end(),
+                                   [](const OverlayArc& arc) { return arc.edge_id == NONE; });
+    }
+    return arc_count;
+}
+
+template <typename Weight>
+std::vector<typename MultilevelOverlayRouter<Weight>::Index> MultilevelOverlayRouter<Weight>::GrowCells(
+    const std::vector<std::vector<Index>>& adjacency, size_t max_size) {
+    const size_t unit_count = adjacency.size();
+
+    std::vector<Index> order;
+    order.reserve(unit_count);
+    std::vector<bool> is_ordered(unit_count, false);
+    for (Index root = 0; root < unit_count; ++root) {
+        if (is_ordered[root]) {
+            continue;
+        }
+        is_ordered[root] = true;
+        order.push_back(root);
+        for (size_t i = order.size() - 1; i < order.size(); ++i) {
+            for (const Index neighbour : adjacency[order[i]]) {
+                if (!is_ordered[neighbour]) {
+                    is_ordered[neighbour] = true;
+                    order.push_back(neighbour);
+                }
+            }
+        }
+    }
+
+    std::vector<Index> positions(unit_count);
+    for (size_t position = 0; position < unit_count; ++position) {
+        positions[order[position]] = static_cast<Index>(position);
+    }
+
+    // a cell takes the free unit with the most links into it next, or the next free unit in the order
+    // when it has no free neighbours left
+    std::vector<Index> cells(unit_count, NONE);
+    std::vector<Index> links(unit_count, 0);
+    // links, the position from the end of the order, unit
+    std::priority_queue<std::tuple<Index, Index, Index>> frontier;
+    Index cell_count = 0;
+    size_t cell_size = 0;
+    const auto take = [&](Index unit) {
+        cells[unit] = cell_count - 1;
+        ++cell_size;
+        for (const Index neighbour : adjacency[unit]) {
+            if (cells[neighbour] == NONE) {
+                frontier.push({++links[neighbour], NONE - positions[neighbour], neighbour});
+            }
+        }
+    };
+    for (const Index seed : order) {
+        if (cells[seed] != NONE) {
+            continue;
+        }
+        if (cell_size == 0 || cell_size == max_size) {
+            // the links into the full cell stay with the units still free, they count as much for every one
+            frontier = {};
+            std::fill(links.begin(), links.end(), 0);
+            ++cell_count;
+            cell_size = 0;
+        }
+        take(seed);
+        while (cell_size < max_size && !frontier.empty()) {
+            const auto [unit_links, reverse_position, unit] = frontier.top();
+            frontier.pop();
+            if (cells[unit] == NONE && unit_links == links[unit]) {
+                take(unit);
+            }
+        }
+    }
+    return cells;
+}
+
+template <typename Weight>
+void MultilevelOverlayRouter<Weight>::Partition(size_t cell_size, size_t level_factor) {
+    const size_t vertex_count = csr_graph_.GetVertexCount();
+    if (vertex_count >= NONE) {
+        throw std::length_error("Graph is too large for a partition");
+    }
+
+    // cells are grown over the edges in both directions
+    std::vector<std::vector<Index>> adjacency(vertex_count);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        for (const auto& arc : csr_graph_.GetArcs(vertex)) {
+            if (arc.to != vertex) {
+                adjacency[vertex].push_back(arc.to);
+                adjacency[arc.to].push_back(static_cast<Index>(vertex));
+            }
+        }
+    }
+    for (auto& neighbours : adjacency) {
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+    }
+
+    cells_.push_back(GrowCells(adjacency, cell_size));
+    cell_counts_.push_back(vertex_count == 0 ? 0 : *std::max_element(cells_[0].begin(), cells_[0].end()) + 1);
+    while (cell_counts_.back() > level_factor) {
+        const std::vector<Index>& cells = cells_.back();
+        std::vector<std::vector<Index>> cell_adjacency(cell_counts_.back());
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            for (const Index neighbour : adjacency[vertex]) {
+                if (cells[vertex] != cells[neighbour]) {
+                    cell_adjacency[cells[vertex]].push_back(cells[neighbour]);
+                }
+            }
+        }
+        for (auto& neighbours : cell_adjacency) {
+            std::sort(neighbours.begin(), neighbours.end());
+            neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+        }
+
+        const std::vector<Index> upper_cells = GrowCells(cell_adjacency, level_factor);
+        const Index upper_cell_count = *std::max_element(upper_cells.begin(), upper_cells.end()) + 1;
+        // the cells left aren't joined to each other
+        if (upper_cell_count == cell_counts_.back()) {
+            break;
+        }
+        std::vector<Index> vertex_cells(vertex_count);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            vertex_cells[vertex] = upper_cells[cells[vertex]];
+        }
+        cells_.push_back(std::move(vertex_cells));
+        cell_counts_.push_back(upper_cell_count);
+    }
+}
+
+template <typename Weight>
+void MultilevelOverlayRouter<Weight>::Customize() {
+    if (graph_.GetEdgeCount() >= NONE) {
+        throw std::length_error("Too many edges for a multilevel overlay");
+    }
+    for (VertexId vertex = 0; vertex < csr_graph_.GetVertexCount(); ++vertex) {
+        for (const auto& arc : csr_graph_.GetArcs(vertex)) {
+            if (arc.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+
+    edge_count_ = graph_.GetEdgeCount();
+    // a level is added once customized, its searches tell the arcs of the levels below by their ids
+    overlays_.clear();
+    for (size_t level = 1; level <= cells_.size(); ++level) {
+        CustomizeLevel(level);
+    }
+}
+
+template <typename Weight>
+void MultilevelOverlayRouter<Weight>::CustomizeLevel(size_t level) {
+    const size_t vertex_count = csr_graph_.GetVertexCount();
+    const std::vector<Index>& cells = cells_[level - 1];
+
+    // the vertexes of every cell with edges to or from the other cells
+    std::vector<bool> is_boundary(vertex_count, false);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        for (const auto& arc : csr_graph_.GetArcs(vertex)) {
+            if (cells[arc.to] != cells[vertex]) {
+                is_boundary[vertex] = true;
+                is_boundary[arc.to] = true;
+            }
+        }
+    }
+    std::vector<std::vector<Index>> cell_boundaries(cell_counts_[level - 1]);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        if (is_boundary[vertex]) {
+            cell_boundaries[cells[vertex]].push_back(static_cast<Index>(vertex));
+        }
+    }
+
+    // an arc whose path passes another boundary vertex is left out, the arcs through that vertex make
+    // the same path; a cell is written only by its own task
+    std::vector<std::vector<OverlayArc>> cell_arcs(cell_counts_[level - 1] + 1);
+    concurrency::ParallelFor(thread_pool_, 0, cell_counts_[level - 1], [&](size_t cell) {
+        Workspace& workspace = GetThreadSearchWorkspace<Weight>();
+        for (const Index from : cell_boundaries[cell]) {
+            SearchCell(workspace, from, level - 1, NONE);
+            for (const Index to : cell_boundaries[cell]) {
+                if (to == from || !workspace.IsReached(to)) {
+                    continue;
+                }
+                bool is_passing = false;
+                for (VertexId vertex = GetArcFrom(workspace.GetPrevEdge(to)); vertex != from && !is_passing;
+                     vertex = GetArcFrom(workspace.GetPrevEdge(vertex))) {
+                    is_passing = is_boundary[vertex] && ZERO_WEIGHT < workspace.GetWeight(vertex);
+                }
+                if (!is_passing) {
+                    cell_arcs[cell].push_back({from, to, workspace.GetWeight(to), NONE});
+                }
+            }
+        }
+    });
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        for (const auto& arc : csr_graph_.GetArcs(vertex)) {
+            if (cells[arc.to] != cells[vertex]) {
+                cell_arcs.back().push_back({static_cast<Index>(vertex), arc.to, arc.weight, arc.edge_id});
+            }
+        }
+    }
+
+    Overlay overlay;
+    overlay.first_arc_id =
+        level == 1 ? edge_count_ : overlays_[level - 2].first_arc_id + overlays_[level - 2].arcs.size();
+    overlay.offsets.assign(vertex_count + 1, 0);
+    for (const auto& arcs : cell_arcs) {
+        for (const OverlayArc& arc : arcs) {
+            ++overlay.offsets[arc.from + 1];
+        }
+    }
+    for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        overlay.offsets[vertex + 1] += overlay.offsets[vertex];
+    }
+    std::vector<Index> positions(overlay.offsets.begin(), overlay.offsets.end() - 1);
+    overlay.arcs.resize(overlay.offsets.back());
+    for (const auto& arcs : cell_arcs) {
+        for (const OverlayArc& arc : arcs) {
+            overlay.arcs[positions[arc.from]++] = arc;
+        }
+    }
+    overlays_.push_back(std::move(overlay));
+}
+
+template <typename Weight>
+size_t MultilevelOverlayRouter<Weight>::GetQueryLevel(VertexId vertex, VertexId from, VertexId to) const {
+    // the cells are nested, so a cell holding neither end holds neither at the levels below
+    for (size_t level = cells_.size(); level > 0; --level) {
+        const std::vector<Index>& cells = cells_[level - 1];
+        if (cells[vertex] != cells[from] && cells[vertex] != cells[to]) {
+            return level;
+        }
+    }
+    return 0;
+}
+
+template <typename Weight>
+template <typename Visit>
+void MultilevelOverlayRouter<Weight>::ForEachArc(VertexId vertex, size_t level, Visit visit) const {
+    if (level == 0) {
+        for (const auto& arc : csr_graph_.GetArcs(vertex)) {
+            visit(arc.to, arc.weight, arc.edge_id);
+        }
+        return;
+    }
+
+    const Overlay& overlay = overlays_[level - 1];
+    for (Index index = overlay.offsets[vertex]; index < overlay.offsets[vertex + 1]; ++index) {
+        const OverlayArc& arc = overlay.arcs[index];
+        visit(arc.to, arc.weight, arc.edge_id == NONE ? overlay.first_arc_id + index : arc.edge_id);
+    }
+}
+
+template <typename Weight>
+void MultilevelOverlayRouter<Weight>::SearchCell(Workspace& workspace, VertexId from, size_t arc_level,
+                                                 VertexId target) const {
+    const std::vector<Index>& cells = cells_[arc_level];
+    const Index cell = cells[from];
+
+    workspace.Reset(csr_graph_.GetVertexCount());
+    workspace.Reach(from, ZERO_WEIGHT);
+    workspace.Push(ZERO_WEIGHT, from);
+    while (!workspace.IsQueueEmpty()) {
+        const auto [weight, vertex] = workspace.GetQueueTop();
+        workspace.Pop();
+        if (workspace.IsSettled(vertex)) {
+            continue;
+        }
+        workspace.Settle(vertex);
+        if (vertex == target) {
+            return;
+        }
+
+        ForEachArc(vertex, arc_level, [&workspace, &cells, cell, weight = weight](VertexId arc_to,
+                                                                                  Weight arc_weight,
+                                                                                  EdgeId arc_id) {
+            if (cells[arc_to] != cell) {
+                return;
+            }
+            const Weight new_weight = weight + arc_weight;
+            if (!workspace.IsReached(arc_to) || new_weight < workspace.GetWeight(arc_to)) {
+                workspace.Reach(arc_to, new_weight, arc_id);
+                workspace.Push(new_weight, arc_to);
+            }
+        });
+    }
+}
+
+template <typename Weight>
+size_t MultilevelOverlayRouter<Weight>::GetArcLevel(EdgeId arc_id) const {
+    // the arc ids of a level follow the ones of the levels below
+    size_t level = overlays_.size();
+    while (level > 0 && arc_id < overlays_[level - 1].first_arc_id) {
+        --level;
+    }
+    return level;
+}
+
+template <typename Weight>
+std::vector<EdgeId> MultilevelOverlayRouter<Weight>::GetSearchArcs(const Workspace& workspace, VertexId from,
+                                                                   VertexId to) const {
+    std::vector<EdgeId> arc_ids;
+    for (VertexId vertex = to; vertex != from;) {
+        const EdgeId arc_id = workspace.GetPrevEdge(vertex);
+        arc_ids.push_back(arc_id);
+        vertex = GetArcFrom(arc_id);
+    }
+    std::reverse(arc_ids.begin(), arc_ids.end());
+    return arc_ids;
+}
+
+template <typename Weight>
+void MultilevelOverlayRouter<Weight>::UnpackArc(EdgeId arc_id, std::vector<EdgeId>& edges) const {
+    const size_t level = GetArcLevel(arc_id);
+    if (level == 0) {
+        edges.push_back(arc_id);
+        return;
+    }
+
+    // the query keeps its own workspace, this one is read out before the arcs below search in it
+    const OverlayArc& arc = GetCliqueArc(level, arc_id);
+    Workspace& workspace = GetThreadSearchWorkspace<Weight>(1);
+    SearchCell(workspace, arc.from, level - 1, arc.to);
+    for (const EdgeId lower_arc_id : GetSearchArcs(workspace, arc.from, arc.to)) {
+        UnpackArc(lower_arc_id, edges);
+    }
+}
+
+}  // namespace graph
@@ -0,0 +1,235 @@
+#pragma once
+
+#include "csr_graph.h"
+#include "graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// finds the Pareto set of the routes between two vertexes by weight and by the number of counted edges,
+// e.g. boardings: the routes no other one beats in both, fastest first
+template <typename Weight>
+class ParetoSearch {
+public:
+    struct ParetoRoute {
+        Weight weight;
+        size_t count;
+        std::vector<EdgeId> edges;
+    };
+
+    // counted_edges flags the edges by their ids, the graphs and the flags must outlive the search
+    ParetoSearch(const CsrGraph<Weight>& forward_graph, const CsrGraph<Weight>& backward_graph,
+                 const std::vector<bool>& counted_edges);
+
+    // in the order of their weights, and so with decreasing counts; none counts more than max_count edges
+    std::vector<ParetoRoute> FindRoutes(VertexId from, VertexId to, size_t max_count) const;
+
+private:
+    using Index = uint32_t;
+
+    static constexpr Index NONE = std::numeric_limits<Index>::max();
+    static constexpr Weight ZERO_WEIGHT{};
+
+    struct Label {
+        Weight weight;
+        Index count;
+        Index vertex;
+        // the edge the label came by and the label it came from, NONE for the start
+        Index edge_id;
+        Index parent;
+    };
+
+    // weight, count, label
+    using QueueItem = std::tuple<Weight, Index, Index>;
+
+    // the memory of the searches of the calling thread, NONE stands for no count
+    struct Scratch {
+        // the least count taken at every vertex
+        std::vector<Index> least_counts;
+        // the least count queued at every vertex and the least weight queued with it, a label they dominate
+        // is left out of the queue
+        std::vector<std::pair<Weight, Index>> queued_labels;
+        // the fewest counted edges from every vertex to the finish, none above the count they're sought up to
+        std::vector<Index> remaining_counts;
+        std::vector<Index> frontier;
+        std::vector<Index> next_frontier;
+        std::vector<Label> labels;
+        std::vector<QueueItem> queue;
+    };
+
+    static Scratch& GetThreadScratch();
+
+    // fills remaining_counts by levels of counted edges, a level first spreads along the uncounted ones
+    void CountRemaining(Scratch& scratch, VertexId to, Index max_count) const;
+
+    const CsrGraph<Weight>& forward_graph_;
+    const CsrGraph<Weight>& backward_graph_;
+    const std::vector<bool>& counted_edges_;
+};
+
+template <typename Weight>
+ParetoSearch<Weight>::ParetoSearch(const CsrGraph<Weight>& forward_graph, const CsrGraph<Weight>& backward_graph,
+                                   const std::vector<bool>& counted_edges)
+: forward_graph_(forward_graph)
+, backward_graph_(backward_graph)
+, counted_edges_(counted_edges)
+{
+    for (VertexId vertex = 0; vertex < forward_graph.GetVertexCount(); ++vertex) {
+        for (const auto& arc : forward_graph.GetArcs(vertex)) {
+            if (arc.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+}
+
+template <typename Weight>
+std::vector<typename ParetoSearch<Weight>::ParetoRoute> ParetoSearch<Weight>::FindRoutes(VertexId from, VertexId to,
+                                                                                       size_t max_count) const {
+    const size_t vertex_count = forward_graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const Index count_limit = static_cast<Index>(std::min<size_t>(max_count, NONE - 1));
+
+    Scratch& scratch = GetThreadScratch();
+    scratch.least_counts.assign(vertex_count, NONE);
+    scratch.queued_labels.assign(vertex_count, {ZERO_WEIGHT, NONE});
+    scratch.labels.clear();
+    scratch.queue.clear();
+    bool is_remaining_counted = false;
+
+    // whether a label of the count at the vertex may still give a route of the Pareto set: once the fastest
+    // route is found, one that can't reach the finish with fewer counted edges than taken there is dropped
+    const auto is_promising = [&scratch, &is_remaining_counted, to, count_limit](VertexId vertex, Index count) {
+        if (count >= scratch.least_counts[vertex]) {
+            return false;
+        }
+        uint64_t finish_count = count;
+        if (is_remaining_counted) {
+            const Index remaining_count = scratch.remaining_counts[vertex];
+            if (remaining_count == NONE) {
+                return false;
+            }
+            finish_count += remaining_count;
+        }
+        return finish_count <= count_limit && finish_count < scratch.least_counts[to];
+    };
+    // a label is pooled in the scratch of the thread when it is queued and points to its parent there,
+    // the ones found dominated later just stay unused
+    const auto push = [&scratch](const Label& label) {
+        auto& [queued_weight, queued_count] = scratch.queued_labels[label.vertex];
+        if (queued_count <= label.count && !(label.weight < queued_weight)) {
+            return;
+        }
+        if (label.count < queued_count || (label.count == queued_count && label.weight < queued_weight)) {
+            queued_weight = label.weight;
+            queued_count = label.count;
+        }
+        scratch.queue.push_back({label.weight, label.count, static_cast<Index>(scratch.labels.size())});
+        std::push_heap(scratch.queue.begin(), scratch.queue.end(), std::greater<QueueItem>{});
+        scratch.labels.push_back(label);
+    };
+    push({ZERO_WEIGHT, 0, static_cast<Index>(from), NONE, NONE});
+
+    std::vector<Index> finish_labels;
+    while (!scratch.queue.empty()) {
+        std::pop_heap(scratch.queue.begin(), scratch.queue.end(), std::greater<QueueItem>{});
+        const auto [weight, count, label_index] = scratch.queue.back();
+        scratch.queue.pop_back();
+
+        // labels are taken by weight, then count, so a label taken before dominates this one unless this one
+        // counts less; a vertex keeps only its least count taken, and its labels lose count as they gain weight
+        const VertexId vertex = scratch.labels[label_index].vertex;
+        if (!is_promising(vertex, count)) {
+            continue;
+        }
+        scratch.least_counts[vertex] = count;
+        if (vertex == to) {
+            if (finish_labels.empty()) {
+                Index min_queued_count = count;
+                for (const QueueItem& item : scratch.queue) {
+                    min_queued_count = std::min(min_queued_count, std::get<1>(item));
+                }
+                // no later label counts less than the least one queued, so the fewest counted edges to the finish
+                // are only sought up to the count that still saves one; otherwise every label left counts no less
+                // than the finish already
+                if (min_queued_count < count) {
+                    CountRemaining(scratch, to, count - 1 - min_queued_count);
+                    is_remaining_counted = true;
+                }
+            }
+            finish_labels.push_back(label_index);
+            continue;
+        }
+
+        for (const auto& arc : forward_graph_.GetArcs(vertex)) {
+            const Index arc_count = counted_edges_[arc.edge_id] ? count + 1 : count;
+            if (is_promising(arc.to, arc_count)) {
+                push({weight + arc.weight, arc_count, arc.to, arc.edge_id, label_index});
+            }
+        }
+    }
+
+    std::vector<ParetoRoute> routes;
+    routes.reserve(finish_labels.size());
+    for (const Index finish_label : finish_labels) {
+        const Label& label = scratch.labels[finish_label];
+        ParetoRoute route{label.weight, label.count, {}};
+        // unwound from the last label by the parents
+        for (Index index = finish_label; scratch.labels[index].parent != NONE; index = scratch.labels[index].parent) {
+            route.edges.push_back(scratch.labels[index].edge_id);
+        }
+        std::reverse(route.edges.begin(), route.edges.end());
+        routes.push_back(std::move(route));
+    }
+    return routes;
+}
+
+template <typename Weight>
+void ParetoSearch<Weight>::CountRemaining(Scratch& scratch, VertexId to, Index max_count) const {
+    scratch.remaining_counts.assign(forward_graph_.GetVertexCount(), NONE);
+    scratch.remaining_counts[to] = 0;
+    scratch.frontier.assign(1, static_cast<Index>(to));
+
+    for (Index level = 0; !scratch.frontier.empty(); ++level) {
+        scratch.next_frontier.clear();
+        // the frontier grows while it's walked, a vertex lowered to this level after it was queued for the next
+        // one is skipped there
+        for (size_t i = 0; i < scratch.frontier.size(); ++i) {
+            const Index vertex = scratch.frontier[i];
+            if (scratch.remaining_counts[vertex] != level) {
+                continue;
+            }
+            for (const auto& arc : backward_graph_.GetArcs(vertex)) {
+                Index& remaining_count = scratch.remaining_counts[arc.to];
+                if (!counted_edges_[arc.edge_id]) {
+                    if (remaining_count > level) {
+                        remaining_count = level;
+                        scratch.frontier.push_back(arc.to);
+                    }
+                } else if (level < max_count && remaining_count > level + 1) {
+                    remaining_count = level + 1;
+                    scratch.next_frontier.push_back(arc.to);
+                }
+            }
+        }
+        std::swap(scratch.frontier, scratch.next_frontier);
+    }
+}
+
+template <typename Weight>
+typename ParetoSearch<Weight>::Scratch& ParetoSearch<Weight>::GetThreadScratch() {
+    thread_local Scratch scratch;
+    return scratch;
+}
+
+}  // namespace graph
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// a monotone min-queue for unsigned integer keys: no key pushed may be less than the last top taken, which
+// Dijkstra searches over non-negative weights guarantee. A key goes to the bucket of the highest bit where it
+// differs from the last top, so the bucket 0 holds the keys equal to it; when it runs out, the next top
+// spreads the first non-empty bucket over the lower ones around its minimum. Every item moves down at most
+// once per bit, which makes an operation O(1) amortized plus O(bits) to find a bucket
+template <typename Key, typename Value>
+class RadixHeap {
+public:
+    static_assert(std::is_unsigned_v<Key>, "radix heap keys should be unsigned integers");
+
+    using Item = std::pair<Key, Value>;
+
+    bool IsEmpty() const { return size_ == 0; }
+
+    // the item with the least key, of equal ones the last pushed; no less key may be pushed afterwards
+    const Item& GetTop();
+
+    void Push(Key key, Value value);
+
+    void Pop();
+
+    void Clear();
+
+private:
+    static constexpr size_t BUCKET_COUNT = std::numeric_limits<Key>::digits + 1;
+
+    // the number of significant bits of the difference from the last top
+    size_t GetBucket(Key key) const {
+        const Key difference = key ^ last_key_;
+        if (difference == 0) {
+            return 0;
+        }
+#if defined(__GNUC__)
+        if constexpr (sizeof(Key) <= sizeof(unsigned long long)) {
+            return std::numeric_limits<unsigned long long>::digits -
+                   static_cast<size_t>(__builtin_clzll(static_cast<unsigned long long>(difference)));
+        }
+#endif
+        size_t bucket = 0;
+        for (Key rest = difference; rest != 0; rest >>= 1) {
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    // refills the empty bucket 0 from the first non-empty bucket
+    void Redistribute();
+
+    std::array<std::vector<Item>, BUCKET_COUNT> buckets_;
+    Key last_key_ = 0;
+    size_t size_ = 0;
+};
+
+template <typename Key, typename Value>
+const typename RadixHeap<Key, Value>::Item& RadixHeap<Key, Value>::GetTop() {
+    if (buckets_[0].empty()) {
+        Redistribute();
+    }
+    return buckets_[0].back();
+}
+
+template <typename Key, typename Value>
+void RadixHeap<Key, Value>::Push(Key key, Value value) {
+    buckets_[GetBucket(key)].push_back({key, value});
+    ++size_;
+}
+
+template <typename Key, typename Value>
+void RadixHeap<Key, Value>::Pop() {
+    GetTop();
+    buckets_[0].pop_back();
+    --size_;
+}
+
+template <typename Key, typename Value>
+void RadixHeap<Key, Value>::Clear() {
+    for (auto& bucket : buckets_) {
+        bucket.clear();
+    }
+    last_key_ = 0;
+    size_ = 0;
+}
+
+template <typename Key, typename Value>
+void RadixHeap<Key, Value>::Redistribute() {
+    size_t source = 1;
+    while (buckets_[source].empty()) {
+        ++source;
+    }
+
+    // the items share the bits above the source bucket with the new last key, so they all go lower
+    std::vector<Item>& items = buckets_[source];
+    last_key_ = std::min_element(items.begin(), items.end(), [](const Item& lhs, const Item& rhs) {
+                    return lhs.first < rhs.first;
+                })->first;
+    for (const Item& item : items) {
+        buckets_[GetBucket(item.first)].push_back(item);
+    }
+    items.clear();
+}
+
+}  // namespace graph
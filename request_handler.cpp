@@ -2,13 +2,22 @@
 
 #include "json_builder.h"
 
+#include <algorithm>
+#include <chrono>
+
 namespace transport_catalogue {
 
 using namespace request_handler;
 
 RequestHandler::RequestHandler(const transport_catalogue::TransportCatalogue& db,
                                const renderer::MapRenderer& renderer, const router::TransportRouter& router)
-    : db_(db), renderer_(renderer), transport_router_(router) {}
+    : db_(db), renderer_(renderer), transport_router_(&router) {}
+
+RequestHandler::RequestHandler(const transport_catalogue::TransportCatalogue& db,
+                               const renderer::MapRenderer& renderer,
+                               std::shared_future<std::unique_ptr<router::TransportRouter>> router,
+                               bool wait_for_router)
+    : db_(db), renderer_(renderer), router_future_(std::move(router)), wait_for_router_(wait_for_router) {}
 
 std::optional<transport_catalogue::BusStatistics> RequestHandler::GetBusStat(
     const std::string_view& bus_name) const {
@@ -33,7 +42,21 @@ json::Node RequestHandler::GetResponseToMapRequest(int id) const {
 
 json::Node RequestHandler::GetResponseToStatRequest(std::string_view type, int id,
                                                     std::optional<std::string_view> name,
-                                                    std::optional<RouteInfo> route_info) const {
+                                                    std::optional<RouteInfo> route_info,
+                                                    std::optional<RouteMatrixInfo> route_matrix_info,
+                                                    std::optional<IsochroneInfo> isochrone_info) const {
+    const bool is_routing = type == "Route"s || type == "RouteMatrix"s || type == "Isochrone"s;
+    if (is_routing && IsRouterWarming()) {
+        return json::Builder{}
+            .StartDict()
+            .Key("request_id"s)
+            .Value(id)
+            .Key("error_message"s)
+            .Value("router warming"s)
+            .EndDict()
+            .Build();
+    }
+
     if (type == "Stop"s) {
         return GetResponseToStopRequeset(name.value(), id);
     } else if (type == "Bus"s) {
@@ -42,6 +65,10 @@ json::Node RequestHandler::GetResponseToStatRequest(std::string_view type, int i
         return GetResponseToMapRequest(id);
     } else if (type == "Route"s) {
         return GetResponseToRouteRequest(id, route_info.value());
+    } else if (type == "RouteMatrix"s) {
+        return GetResponseToRouteMatrixRequest(id, route_matrix_info.value());
+    } else if (type == "Isochrone"s) {
+        return GetResponseToIsochroneRequest(id, isochrone_info.value());
     }
 
     throw std::logic_error("unsupported type"s);
@@ -53,8 +80,28 @@ json::Node RequestHandler::GetResponseToRouteRequest(int id, RouteInfo route_inf
     StopPtr from = db_.GetStop(route_info.from);
     StopPtr to = db_.GetStop(route_info.to);
 
+    if (route_info.alternatives < 0 || route_info.alternatives > RouteInfo::MAX_ALTERNATIVES ||
+        !(route_info.max_time_gap >= 0.0) || route_info.max_boardings < 0 ||
+        (route_info.pareto && route_info.alternatives > 0)) {
+        return json::Builder{}
+            .StartDict()
+            .Key("request_id"s)
+            .Value(id)
+            .Key("error_message"s)
+            .Value("invalid route request"s)
+            .EndDict()
+            .Build();
+    }
+
+    if (route_info.pareto) {
+        return GetResponseToParetoRoutesRequest(id, from, to, route_info);
+    }
+    if (route_info.alternatives > 0) {
+        return GetResponseToAlternativeRoutesRequest(id, from, to, route_info);
+    }
+
     std::optional<std::pair<Minutes, std::vector<TransportRouter::RouteItem>>> route =
-        transport_router_.GetRouteInfo(from, to);
+        GetRouter().GetRouteInfo(from, to);
 
     if (!route) {
         return json::Builder{}
@@ -67,17 +114,202 @@ json::Node RequestHandler::GetResponseToRouteRequest(int id, RouteInfo route_inf
             .Build();
     }
 
-    json::Builder builder_node;
-
-    builder_node.StartDict()
+    return json::Builder{}
+        .StartDict()
         .Key("request_id"s)
         .Value(id)
         .Key("total_time"s)
         .Value(route->first)
         .Key("items"s)
-        .StartArray();
+        .Value(BuildRouteItems(route->second).AsArray())
+        .EndDict()
+        .Build();
+}
+
+json::Node RequestHandler::GetResponseToAlternativeRoutesRequest(int id, StopPtr from, StopPtr to,
+                                                                 const RouteInfo& route_info) const {
+    using namespace router;
+
+    // the best route comes from the same search as the alternatives, so none of them repeats it
+    const std::vector<TransportRouter::Route> routes = GetRouter().GetAlternativeRoutes(
+        from, to, static_cast<size_t>(route_info.alternatives), route_info.max_time_gap);
+
+    if (routes.empty()) {
+        return json::Builder{}
+            .StartDict()
+            .Key("request_id"s)
+            .Value(id)
+            .Key("error_message"s)
+            .Value("not found"s)
+            .EndDict()
+            .Build();
+    }
+
+    json::Array alternatives;
+    for (auto route = routes.begin() + 1; route != routes.end(); ++route) {
+        alternatives.push_back(json::Builder{}
+                                   .StartDict()
+                                   .Key("total_time"s)
+                                   .Value(route->first)
+                                   .Key("items"s)
+                                   .Value(BuildRouteItems(route->second).AsArray())
+                                   .EndDict()
+                                   .Build());
+    }
+
+    return json::Builder{}
+        .StartDict()
+        .Key("request_id"s)
+        .Value(id)
+        .Key("total_time"s)
+        .Value(routes.front().first)
+        .Key("items"s)
+        .Value(BuildRouteItems(routes.front().second).AsArray())
+        .Key("alternatives"s)
+        .Value(std::move(alternatives))
+        .EndDict()
+        .Build();
+}
 
-    for (const auto& route_item : route->second) {
+json::Node RequestHandler::GetResponseToParetoRoutesRequest(int id, StopPtr from, StopPtr to,
+                                                            const RouteInfo& route_info) const {
+    using namespace router;
+
+    const std::vector<TransportRouter::Route> routes =
+        GetRouter().GetParetoRoutes(from, to, static_cast<size_t>(route_info.max_boardings));
+
+    if (routes.empty()) {
+        return json::Builder{}
+            .StartDict()
+            .Key("request_id"s)
+            .Value(id)
+            .Key("error_message"s)
+            .Value("not found"s)
+            .EndDict()
+            .Build();
+    }
+
+    // every route boards once per wait
+    json::Array pareto;
+    for (const auto& route : routes) {
+        const auto boarding_count = std::count_if(route.second.begin(), route.second.end(), [](const auto& item) {
+            return std::holds_alternative<TransportRouter::WaitInfo>(item);
+        });
+        pareto.push_back(json::Builder{}
+                             .StartDict()
+                             .Key("total_time"s)
+                             .Value(route.first)
+                             .Key("boarding_count"s)
+                             .Value(static_cast<int>(boarding_count))
+                             .Key("items"s)
+                             .Value(BuildRouteItems(route.second).AsArray())
+                             .EndDict()
+                             .Build());
+    }
+
+    return json::Builder{}
+        .StartDict()
+        .Key("request_id"s)
+        .Value(id)
+        .Key("total_time"s)
+        .Value(routes.front().first)
+        .Key("items"s)
+        .Value(BuildRouteItems(routes.front().second).AsArray())
+        .Key("pareto"s)
+        .Value(std::move(pareto))
+        .EndDict()
+        .Build();
+}
+
+json::Node RequestHandler::GetResponseToRouteMatrixRequest(int id, const RouteMatrixInfo& route_matrix_info) const {
+    using namespace router;
+
+    // unknown stops are reported like unknown stops of the other requests
+    std::vector<StopPtr> stops_from;
+    std::vector<StopPtr> stops_to;
+    for (const auto& [names, stops] : {std::pair{&route_matrix_info.from, &stops_from},
+                                       std::pair{&route_matrix_info.to, &stops_to}}) {
+        for (const std::string_view name : *names) {
+            if (db_.CountStop(name) == 0) {
+                return json::Builder{}
+                    .StartDict()
+                    .Key("request_id"s)
+                    .Value(id)
+                    .Key("error_message"s)
+                    .Value("not found"s)
+                    .EndDict()
+                    .Build();
+            }
+            stops->push_back(db_.GetStop(name));
+        }
+    }
+
+    const TransportRouter::RouteMatrix matrix =
+        GetRouter().GetRouteMatrix(stops_from, stops_to, route_matrix_info.with_items);
+
+    // a route that doesn't exist is null in both matrices
+    json::Array total_times;
+    json::Array itineraries;
+    for (const auto& row : matrix) {
+        json::Array total_times_row;
+        json::Array itineraries_row;
+        for (const auto& route : row) {
+            total_times_row.emplace_back(route ? json::Node(route->first) : json::Node(nullptr));
+            if (route_matrix_info.with_items) {
+                itineraries_row.push_back(route ? BuildRouteItems(route->second) : json::Node(nullptr));
+            }
+        }
+        total_times.emplace_back(std::move(total_times_row));
+        itineraries.emplace_back(std::move(itineraries_row));
+    }
+
+    json::Builder builder_node;
+
+    builder_node.StartDict().Key("request_id"s).Value(id).Key("total_times"s).Value(std::move(total_times));
+    if (route_matrix_info.with_items) {
+        builder_node.Key("itineraries"s).Value(std::move(itineraries));
+    }
+
+    return builder_node.EndDict().Build();
+}
+
+json::Node RequestHandler::GetResponseToIsochroneRequest(int id, IsochroneInfo isochrone_info) const {
+    using namespace router;
+
+    if (db_.CountStop(isochrone_info.stop) == 0) {
+        return json::Builder{}
+            .StartDict()
+            .Key("request_id"s)
+            .Value(id)
+            .Key("error_message"s)
+            .Value("not found"s)
+            .EndDict()
+            .Build();
+    }
+
+    const auto direction = isochrone_info.is_reverse ? TransportRouter::IsochroneDirection::TO_STOP
+                                                     : TransportRouter::IsochroneDirection::FROM_STOP;
+
+    json::Builder builder_node;
+
+    builder_node.StartDict().Key("request_id"s).Value(id).Key("stops"s).StartArray();
+
+    for (const auto& [stop_name, time] :
+         GetRouter().GetIsochrone(db_.GetStop(isochrone_info.stop), isochrone_info.max_time, direction)) {
+        builder_node.StartDict().Key("stop_name"s).Value(std::string(stop_name)).Key("time"s).Value(time).EndDict();
+    }
+
+    return builder_node.EndArray().EndDict().Build();
+}
+
+json::Node RequestHandler::BuildRouteItems(const std::vector<router::TransportRouter::RouteItem>& route_items) const {
+    using namespace router;
+
+    json::Builder builder_node;
+
+    builder_node.StartArray();
+
+    for (const auto& route_item : route_items) {
         if (const auto wait_info_ptr = std::get_if<TransportRouter::WaitInfo>(&route_item)) {
             builder_node.StartDict()
                 .Key("type"s)
@@ -103,7 +335,7 @@ json::Node RequestHandler::GetResponseToRouteRequest(int id, RouteInfo route_inf
         }
     }
 
-    return builder_node.EndArray().EndDict().Build();
+    return builder_node.EndArray().Build();
 }
 
 json::Node RequestHandler::GetResponseToStopRequeset(std::string_view name, int id) const {
@@ -183,4 +415,13 @@ const std::set<BusPtr, BusPointerComparator>* RequestHandler::GetBusesByStop(
     throw std::logic_error(error_msg.str());
 }
 
+const router::TransportRouter& RequestHandler::GetRouter() const {
+    return transport_router_ ? *transport_router_ : *router_future_.get();
+}
+
+bool RequestHandler::IsRouterWarming() const {
+    return !transport_router_ && !wait_for_router_ &&
+           router_future_.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
 }  // namespace transport_catalogue
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <future>
+#include <memory>
 #include <optional>
 #include <sstream>
 #include <unordered_set>
@@ -22,11 +24,20 @@ public:
     RequestHandler(const transport_catalogue::TransportCatalogue& db, const renderer::MapRenderer& renderer,
                    const router::TransportRouter& router);
 
+    // the router is built on another thread meanwhile, so the requests that don't route are answered at once;
+    // the route, route matrix and isochrone requests wait for it, or without wait_for_router are answered
+    // with the "router warming" error until it is built
+    RequestHandler(const transport_catalogue::TransportCatalogue& db, const renderer::MapRenderer& renderer,
+                   std::shared_future<std::unique_ptr<router::TransportRouter>> router,
+                   bool wait_for_router = true);
+
     // Возвращает информацию о маршруте (запрос Bus)
     std::optional<transport_catalogue::BusStatistics> GetBusStat(const std::string_view& bus_name) const;
 
     json::Node GetResponseToStatRequest(std::string_view type, int id, std::optional<std::string_view> name = {},
-                                        std::optional<RouteInfo> route_info = {}) const;
+                                        std::optional<RouteInfo> route_info = {},
+                                        std::optional<RouteMatrixInfo> route_matrix_info = {},
+                                        std::optional<IsochroneInfo> isochrone_info = {}) const;
 
     std::unique_ptr<svg::Document> RenderMap() const;
 
@@ -41,10 +52,31 @@ private:
 
     json::Node GetResponseToRouteRequest(int id, RouteInfo route_info) const;
 
+    // the best route and its alternatives, answered only when alternatives are asked for
+    json::Node GetResponseToAlternativeRoutesRequest(int id, StopPtr from, StopPtr to,
+                                                     const RouteInfo& route_info) const;
+
+    // the fastest route and the whole Pareto set by time and boardings, answered only when it's asked for
+    json::Node GetResponseToParetoRoutesRequest(int id, StopPtr from, StopPtr to, const RouteInfo& route_info) const;
+
+    json::Node GetResponseToRouteMatrixRequest(int id, const RouteMatrixInfo& route_matrix_info) const;
+
+    json::Node GetResponseToIsochroneRequest(int id, IsochroneInfo isochrone_info) const;
+
+    json::Node BuildRouteItems(const std::vector<router::TransportRouter::RouteItem>& route_items) const;
+
+    // waits for the router if it's still building
+    const router::TransportRouter& GetRouter() const;
+
+    bool IsRouterWarming() const;
+
 private:
     const transport_catalogue::TransportCatalogue& db_;
     const renderer::MapRenderer& renderer_;
-    const router::TransportRouter& transport_router_;
+    // either the router given or the one built on another thread
+    const router::TransportRouter* transport_router_ = nullptr;
+    std::shared_future<std::unique_ptr<router::TransportRouter>> router_future_;
+    bool wait_for_router_ = true;
 };
 
 }  // namespace request_handler
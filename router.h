@@ -1,113 +1,455 @@
 #pragma once
 
 #include "graph.h"
+#include "min_plus.h"
+#include "thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdint>
+#include <functional>
+#include <istream>
 #include <iterator>
+#include <limits>
 #include <optional>
+#include <queue>
 #include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace graph {
 
+// common interface of all routing engines, so that callers can pick one at runtime
 template <typename Weight>
-class Router {
-private:
-    using Graph = DirectedWeightedGraph<Weight>;
-
+class RouterBase {
 public:
-    explicit Router(const Graph& graph);
-
     struct RouteInfo {
         Weight weight;
         std::vector<EdgeId> edges;
     };
 
-    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    virtual ~RouterBase() = default;
 
+    virtual std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const = 0;
+
+    // routes from one vertex to every target in their order; engines that grow a search tree from the start
+    // override it to answer all the targets with one search
+    virtual std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from,
+                                                              const std::vector<VertexId>& targets) const;
+
+    // the edges were added to the graph of the router, removed from it or got other weights; an engine that
+    // can patch its data does and returns true, the others return false and must be built anew
+    virtual bool UpdateEdges(const std::vector<EdgeId>& /*edge_ids*/) { return false; }
+};
+
+template <typename Weight>
+std::vector<std::optional<typename RouterBase<Weight>::RouteInfo>> RouterBase<Weight>::BuildRoutes(
+    VertexId from, const std::vector<VertexId>& targets) const {
+    std::vector<std::optional<RouteInfo>> routes;
+    routes.reserve(targets.size());
+    for (const VertexId to : targets) {
+        routes.push_back(BuildRoute(from, to));
+    }
+    return routes;
+}
+
+// bytes left in a stream an engine loads its data from, to check the counts read from it before allocating
+// for them; the largest value if the stream can't tell
+inline uint64_t GetRemainingSize(std::istream& input) {
+    const std::istream::pos_type position = input.tellg();
+    if (position == std::istream::pos_type(-1)) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+    input.seekg(0, std::ios_base::end);
+    const std::istream::pos_type end = input.tellg();
+    input.seekg(position);
+    if (end == std::istream::pos_type(-1) || end < position) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+    return static_cast<uint64_t>(end - position);
+}
+
+// precomputes all routes with Floyd-Warshall: O(V^3) time and O(V^2) memory, O(route length) queries,
+// the precompute can be split between several threads
+template <typename Weight>
+class Router : public RouterBase<Weight> {
 private:
-    struct RouteInternalData {
-        Weight weight;
-        std::optional<EdgeId> prev_edge;
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+
+    // routes are kept in two flat row-major V x V tables instead of optional cells:
+    // an unreachable route has INFINITE_WEIGHT, a route without edges has NO_EDGE
+    using PrevEdgeId = uint32_t;
+
+    struct Table {
+        const Weight* weights = nullptr;
+        const PrevEdgeId* prev_edges = nullptr;
     };
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+
+    // the build and the updates run on the pool, which must outlive the router, or on the calling thread
+    explicit Router(const Graph& graph, concurrency::ThreadPool* thread_pool = nullptr);
+
+    // uses tables precomputed for the same graph, which must outlive the router or its first update;
+    // throws std::invalid_argument if a route of them doesn't walk back to its start, the rows are checked
+    // on the pool
+    Router(const Graph& graph, Table table, concurrency::ThreadPool* thread_pool = nullptr);
+
+    Router(const Router&) = delete;
+    Router& operator=(const Router&) = delete;
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    // searches anew only the rows whose routes the edges can change: a row that takes a changed edge
+    // in its routes, or one a changed edge makes a shorter route for; the other rows keep their routes
+    bool UpdateEdges(const std::vector<EdgeId>& edge_ids) override;
+
+    Table GetTable() const { return table_; }
+
+    size_t GetCellCount() const { return vertex_count_ * vertex_count_; }
+
+    static constexpr PrevEdgeId NO_EDGE = std::numeric_limits<PrevEdgeId>::max();
+    static constexpr Weight INFINITE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+                                                  ? std::numeric_limits<Weight>::infinity()
+                                                  : std::numeric_limits<Weight>::max();
+
+private:
+
+    size_t GetCellIndex(VertexId vertex_from, VertexId vertex_to) const {
+        return vertex_from * vertex_count_ + vertex_to;
+    }
 
     void InitializeRoutesInternalData(const Graph& graph) {
-        const size_t vertex_count = graph.GetVertexCount();
-        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-            routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+        if (graph.GetEdgeCount() >= NO_EDGE) {
+            throw std::length_error("Too many edges for all-pairs router");
+        }
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            weights_[GetCellIndex(vertex, vertex)] = ZERO_WEIGHT;
             for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
                 const auto& edge = graph.GetEdge(edge_id);
                 if (edge.weight < ZERO_WEIGHT) {
                     throw std::domain_error("Edges' weights should be non-negative");
                 }
-                auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                    route_internal_data = RouteInternalData{edge.weight, edge_id};
+                const size_t cell = GetCellIndex(vertex, edge.to);
+                if (weights_[cell] == INFINITE_WEIGHT || weights_[cell] > edge.weight) {
+                    weights_[cell] = edge.weight;
+                    prev_edges_[cell] = static_cast<PrevEdgeId>(edge_id);
                 }
             }
         }
     }
 
-    void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-                    const RouteInternalData& route_to) {
-        auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-        const Weight candidate_weight = route_from.weight + route_to.weight;
-        if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-            route_relaxing = {candidate_weight,
-                route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+    // relaxes one row segment of routes from some vertex through a vertex with the row of that vertex
+    static void RelaxRow(Weight weight_from, PrevEdgeId prev_edge_from, const Weight* weights_through,
+                         const PrevEdgeId* prev_edges_through, Weight* weights_relaxing,
+                         PrevEdgeId* prev_edges_relaxing, size_t count) {
+        if constexpr (std::is_same_v<Weight, double> || std::is_same_v<Weight, float>) {
+            min_plus::RelaxRow(weight_from, prev_edge_from, weights_through, prev_edges_through, weights_relaxing,
+                               prev_edges_relaxing, count);
+        } else {
+            min_plus::RelaxRowScalar(weight_from, prev_edge_from, weights_through, prev_edges_through,
+                                     weights_relaxing, prev_edges_relaxing, count, INFINITE_WEIGHT, NO_EDGE);
         }
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
+    // relaxes routes between two blocks through the vertexes of a third, saving the cells of every vertex
+    // to the panels first so the relaxations see the cells of the plain vertex by vertex order
+    void RelaxBlock(size_t block_from, size_t block_to, size_t block_through) {
+        const VertexId from_begin = block_from * BLOCK_SIZE;
+        const VertexId from_end = std::min(vertex_count_, from_begin + BLOCK_SIZE);
+        const VertexId to_begin = block_to * BLOCK_SIZE;
+        const size_t to_count = std::min(vertex_count_, to_begin + BLOCK_SIZE) - to_begin;
+        const VertexId through_begin = block_through * BLOCK_SIZE;
+        const VertexId through_end = std::min(vertex_count_, through_begin + BLOCK_SIZE);
+
+        for (VertexId vertex_through = through_begin; vertex_through < through_end; ++vertex_through) {
+            const size_t panel_through = vertex_through - through_begin;
+
+            if (block_to == block_through) {
+                for (VertexId vertex_from = from_begin; vertex_from < from_end; ++vertex_from) {
+                    const size_t cell = GetCellIndex(vertex_from, vertex_through);
+                    column_panel_weights_[vertex_from * BLOCK_SIZE + panel_through] = weights_[cell];
+                    column_panel_prev_edges_[vertex_from * BLOCK_SIZE + panel_through] = prev_edges_[cell];
+                }
+            }
+            if (block_from == block_through) {
+                const size_t cell = GetCellIndex(vertex_through, to_begin);
+                std::copy_n(&weights_[cell], to_count, &row_panel_weights_[panel_through * vertex_count_ + to_begin]);
+                std::copy_n(&prev_edges_[cell], to_count,
+                            &row_panel_prev_edges_[panel_through * vertex_count_ + to_begin]);
+            }
+
+            const size_t row_through = panel_through * vertex_count_ + to_begin;
+            for (VertexId vertex_from = from_begin; vertex_from < from_end; ++vertex_from) {
+                const size_t column_from = vertex_from * BLOCK_SIZE + panel_through;
+                if (column_panel_weights_[column_from] == INFINITE_WEIGHT) {
+                    continue;
+                }
+                const size_t cell_relaxing = GetCellIndex(vertex_from, to_begin);
+                RelaxRow(column_panel_weights_[column_from], column_panel_prev_edges_[column_from],
+                         &row_panel_weights_[row_through], &row_panel_prev_edges_[row_through],
+                         &weights_[cell_relaxing], &prev_edges_[cell_relaxing], to_count);
+            }
+        }
+    }
+
+    // blocked Floyd-Warshall: for every diagonal block, first the block itself, then its row and column,
+    // then all the other blocks, the blocks within the last two phases are independent and run in parallel
+    void RelaxRoutesInternalData() {
+        const size_t block_count = (vertex_count_ + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        row_panel_weights_.resize(BLOCK_SIZE * vertex_count_);
+        row_panel_prev_edges_.resize(BLOCK_SIZE * vertex_count_);
+        column_panel_weights_.resize(vertex_count_ * BLOCK_SIZE);
+        column_panel_prev_edges_.resize(vertex_count_ * BLOCK_SIZE);
+
+        for (size_t block_through = 0; block_through < block_count; ++block_through) {
+            RelaxBlock(block_through, block_through, block_through);
+
+            concurrency::ParallelFor(thread_pool_, 0, block_count, [this, block_through](size_t block) {
+                if (block != block_through) {
+                    RelaxBlock(block_through, block, block_through);
+                    RelaxBlock(block, block_through, block_through);
+                }
+            });
+
+            const auto relax_row_of_blocks = [this, block_through, block_count](size_t block_from) {
+                if (block_from == block_through) {
+                    return;
+                }
+                for (size_t block_to = 0; block_to < block_count; ++block_to) {
+                    if (block_to != block_through) {
+                        RelaxBlock(block_from, block_to, block_through);
                     }
                 }
+            };
+            concurrency::ParallelFor(thread_pool_, 0, block_count, relax_row_of_blocks);
+        }
+
+        row_panel_weights_ = {};
+        row_panel_prev_edges_ = {};
+        column_panel_weights_ = {};
+        column_panel_prev_edges_ = {};
+    }
+
+    // an unchanged row is still a tree of shortest routes if none of the edges is in it and none of them
+    // makes a route shorter than the row has, since the row then keeps the triangle inequality on every edge
+    bool IsRowAffected(VertexId vertex_from, const std::vector<EdgeId>& edge_ids) const {
+        for (const EdgeId edge_id : edge_ids) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const size_t cell_to = GetCellIndex(vertex_from, edge.to);
+            if (prev_edges_[cell_to] == edge_id) {
+                return true;
+            }
+            const Weight weight_from = weights_[GetCellIndex(vertex_from, edge.from)];
+            if (!graph_.IsEdgeRemoved(edge_id) && weight_from != INFINITE_WEIGHT &&
+                weight_from + edge.weight < weights_[cell_to]) {
+                return true;
             }
         }
+        return false;
     }
 
+    // whether the edges of a loaded row lead from its vertex to every vertex it reaches and only to them,
+    // so walking them back ends at the vertex
+    bool IsRouteTree(VertexId vertex_from, std::vector<uint8_t>& states) const {
+        enum : uint8_t { UNSEEN, ON_PATH, ROOTED };
+
+        const Weight* weights = &table_.weights[GetCellIndex(vertex_from, 0)];
+        const PrevEdgeId* prev_edges = &table_.prev_edges[GetCellIndex(vertex_from, 0)];
+        if (weights[vertex_from] != ZERO_WEIGHT || prev_edges[vertex_from] != NO_EDGE) {
+            return false;
+        }
+        states.assign(vertex_count_, UNSEEN);
+        states[vertex_from] = ROOTED;
+        std::vector<VertexId> path;
+        for (VertexId vertex_to = 0; vertex_to < vertex_count_; ++vertex_to) {
+            const bool has_edge = prev_edges[vertex_to] != NO_EDGE;
+            if (!(weights[vertex_to] >= ZERO_WEIGHT) ||
+                (weights[vertex_to] != INFINITE_WEIGHT) != (has_edge || vertex_to == vertex_from)) {
+                return false;
+            }
+            if (!has_edge) {
+                continue;
+            }
+            VertexId vertex = vertex_to;
+            while (states[vertex] == UNSEEN) {
+                if (prev_edges[vertex] == NO_EDGE || prev_edges[vertex] >= graph_.GetEdgeCount() ||
+                    graph_.IsEdgeRemoved(prev_edges[vertex]) || graph_.GetEdge(prev_edges[vertex]).to != vertex) {
+                    return false;
+                }
+                states[vertex] = ON_PATH;
+                path.push_back(vertex);
+                vertex = graph_.GetEdge(prev_edges[vertex]).from;
+            }
+            if (states[vertex] == ON_PATH) {
+                return false;
+            }
+            for (const VertexId path_vertex : path) {
+                states[path_vertex] = ROOTED;
+            }
+            path.clear();
+        }
+        return true;
+    }
+
+    // fills one row with a Dijkstra search over the current graph
+    void SearchRow(VertexId vertex_from) {
+        Weight* weights = &weights_[GetCellIndex(vertex_from, 0)];
+        PrevEdgeId* prev_edges = &prev_edges_[GetCellIndex(vertex_from, 0)];
+        std::fill_n(weights, vertex_count_, INFINITE_WEIGHT);
+        std::fill_n(prev_edges, vertex_count_, NO_EDGE);
+        std::vector<bool> settled(vertex_count_, false);
+
+        using QueueItem = std::pair<Weight, VertexId>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        weights[vertex_from] = ZERO_WEIGHT;
+        queue.push({ZERO_WEIGHT, vertex_from});
+
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (settled[vertex]) {
+                continue;
+            }
+            settled[vertex] = true;
+
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                const Weight candidate_weight = weight + edge.weight;
+                if (candidate_weight < weights[edge.to]) {
+                    weights[edge.to] = candidate_weight;
+                    prev_edges[edge.to] = static_cast<PrevEdgeId>(edge_id);
+                    queue.push({candidate_weight, edge.to});
+                }
+            }
+        }
+    }
+
+    // 64 x 64 cells of weights and edges fit in L1 cache
+    static constexpr size_t BLOCK_SIZE = 64;
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
-    RoutesInternalData routes_internal_data_;
+    size_t vertex_count_;
+    concurrency::ThreadPool* thread_pool_;
+    std::vector<Weight> weights_;
+    std::vector<PrevEdgeId> prev_edges_;
+    // points either to the own vectors above or to external tables
+    Table table_;
+
+    // cells of the current diagonal block's rows (BLOCK_SIZE x V) and columns (V x BLOCK_SIZE),
+    // only needed during the precompute
+    std::vector<Weight> row_panel_weights_;
+    std::vector<PrevEdgeId> row_panel_prev_edges_;
+    std::vector<Weight> column_panel_weights_;
+    std::vector<PrevEdgeId> column_panel_prev_edges_;
 };
 
 template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+Router<Weight>::Router(const Graph& graph, concurrency::ThreadPool* thread_pool)
 : graph_(graph)
-, routes_internal_data_(graph.GetVertexCount(),
-                        std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+, vertex_count_(graph.GetVertexCount())
+, thread_pool_(thread_pool)
+, weights_(vertex_count_ * vertex_count_, INFINITE_WEIGHT)
+, prev_edges_(vertex_count_ * vertex_count_, NO_EDGE)
 {
     InitializeRoutesInternalData(graph);
+    RelaxRoutesInternalData();
+    table_ = Table{weights_.data(), prev_edges_.data()};
+}
+
+template <typename Weight>
+Router<Weight>::Router(const Graph& graph, Table table, concurrency::ThreadPool* thread_pool)
+: graph_(graph)
+, vertex_count_(graph.GetVertexCount())
+, thread_pool_(thread_pool)
+, table_(table)
+{
+    if (graph.GetEdgeCount() >= NO_EDGE) {
+        throw std::length_error("Too many edges for all-pairs router");
+    }
+    // a row is read only by its own task
+    std::vector<uint8_t> is_row_valid(vertex_count_, 0);
+    concurrency::ParallelFor(thread_pool_, 0, vertex_count_, [this, &is_row_valid](size_t vertex_from) {
+        std::vector<uint8_t> states;
+        is_row_valid[vertex_from] = IsRouteTree(vertex_from, states) ? 1 : 0;
+    });
+    if (std::count(is_row_valid.begin(), is_row_valid.end(), 0) > 0) {
+        throw std::invalid_argument("All-pairs table doesn't match the graph");
+    }
+}
+
+template <typename Weight>
+bool Router<Weight>::UpdateEdges(const std::vector<EdgeId>& edge_ids) {
+    if (graph_.GetVertexCount() != vertex_count_) {
+        return false;
+    }
+    if (graph_.GetEdgeCount() >= NO_EDGE) {
+        throw std::length_error("Too many edges for all-pairs router");
+    }
+    for (const EdgeId edge_id : edge_ids) {
+        if (graph_.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+
+    // external tables are read-only
+    if (table_.weights != weights_.data()) {
+        const size_t cell_count = GetCellCount();
+        weights_.assign(table_.weights, table_.weights + cell_count);
+        prev_edges_.assign(table_.prev_edges, table_.prev_edges + cell_count);
+        table_ = Table{weights_.data(), prev_edges_.data()};
+    }
+
+    // a row is read and written only by its own task
+    std::vector<uint8_t> is_row_affected(vertex_count_, 0);
+    concurrency::ParallelFor(thread_pool_, 0, vertex_count_, [this, &edge_ids, &is_row_affected](size_t vertex) {
+        is_row_affected[vertex] = IsRowAffected(vertex, edge_ids) ? 1 : 0;
+    });
+    const size_t affected_row_count = std::count(is_row_affected.begin(), is_row_affected.end(), 1);
 
-    const size_t vertex_count = graph.GetVertexCount();
-    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+    // a row search takes about E log V steps and the whole Floyd-Warshall about V^3 steps as cheap,
+    // so a change that affects many rows of a dense graph computes the table anew
+    const double vertex_count = static_cast<double>(vertex_count_);
+    const double row_search_cost =
+        (static_cast<double>(graph_.GetEdgeCount()) + vertex_count) * std::log2(vertex_count + 1.0);
+    if (static_cast<double>(affected_row_count) * row_search_cost > vertex_count * vertex_count * vertex_count) {
+        std::fill(weights_.begin(), weights_.end(), INFINITE_WEIGHT);
+        std::fill(prev_edges_.begin(), prev_edges_.end(), NO_EDGE);
+        InitializeRoutesInternalData(graph_);
+        RelaxRoutesInternalData();
+        return true;
     }
+
+    concurrency::ParallelFor(thread_pool_, 0, vertex_count_, [this, &is_row_affected](size_t vertex_from) {
+        if (is_row_affected[vertex_from]) {
+            SearchRow(vertex_from);
+        }
+    });
+
+    return true;
 }
 
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-    if (!route_internal_data) {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const size_t cell = GetCellIndex(from, to);
+    if (table_.weights[cell] == INFINITE_WEIGHT) {
         return std::nullopt;
     }
-    const Weight weight = route_internal_data->weight;
+    const Weight weight = table_.weights[cell];
     std::vector<EdgeId> edges;
-    for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-         edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+    for (PrevEdgeId edge_id = table_.prev_edges[cell];
+         edge_id != NO_EDGE;
+         edge_id = table_.prev_edges[GetCellIndex(from, graph_.GetEdge(edge_id).from)])
     {
-        edges.push_back(*edge_id);
+        edges.push_back(edge_id);
     }
     std::reverse(edges.begin(), edges.end());
 
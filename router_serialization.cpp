@@ -0,0 +1,158 @@
+#include "router_serialization.h"
+
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ROUTER_SERIALIZATION_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace transport_catalogue {
+
+namespace router {
+
+namespace serialization {
+
+namespace {
+
+class Fnv1aHasher {
+public:
+    void Add(const void* data, size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash_ = (hash_ ^ bytes[i]) * kPrime;
+        }
+    }
+
+    template <typename Value>
+    void AddValue(Value value) {
+        Add(&value, sizeof(value));
+    }
+
+    void AddString(std::string_view value) {
+        AddValue<uint64_t>(value.size());
+        Add(value.data(), value.size());
+    }
+
+    uint64_t GetHash() const { return hash_; }
+
+private:
+    static constexpr uint64_t kOffsetBasis = 14695981039346656037ull;
+    static constexpr uint64_t kPrime = 1099511628211ull;
+
+    uint64_t hash_ = kOffsetBasis;
+};
+
+}  // namespace
+
+uint64_t ComputeChecksum(const TransportCatalogue& catalogue, const RoutingSettings& settings) {
+    Fnv1aHasher hasher;
+
+    hasher.AddValue<uint64_t>(catalogue.GetAllStops().size());
+    for (const Stop& stop : catalogue.GetAllStops()) {
+        hasher.AddString(stop.name);
+        hasher.AddValue(stop.coordinates.lat);
+        hasher.AddValue(stop.coordinates.lng);
+    }
+
+    hasher.AddValue<uint64_t>(catalogue.GetAllBuses().size());
+    for (const Bus& bus : catalogue.GetAllBuses()) {
+        hasher.AddString(bus.name);
+        hasher.AddValue(bus.is_circular);
+        hasher.AddValue<uint64_t>(bus.stops.size());
+        for (size_t i = 0; i < bus.stops.size(); ++i) {
+            hasher.AddString(bus.stops[i]->name);
+            // the router only uses distances between neighbouring stops of the buses
+            if (i > 0) {
+                hasher.AddValue(catalogue.GetDistanceBetweenStops(bus.stops[i - 1], bus.stops[i]));
+                hasher.AddValue(catalogue.GetDistanceBetweenStops(bus.stops[i], bus.stops[i - 1]));
+            }
+        }
+    }
+
+    hasher.AddValue(settings.wait_time);
+    hasher.AddValue(settings.velocity);
+
+    return hasher.GetHash();
+}
+
+std::optional<MappedFile> MappedFile::Open(const std::string& path) {
+    MappedFile file;
+
+#ifdef ROUTER_SERIALIZATION_MMAP
+    const int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return std::nullopt;
+    }
+
+    struct stat file_stat {};
+    if (fstat(descriptor, &file_stat) != 0) {
+        close(descriptor);
+        return std::nullopt;
+    }
+
+    file.size_ = static_cast<size_t>(file_stat.st_size);
+    if (file.size_ > 0) {
+        void* data = mmap(nullptr, file.size_, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (data == MAP_FAILED) {
+            close(descriptor);
+            return std::nullopt;
+        }
+        file.data_ = static_cast<const char*>(data);
+        file.is_mapped_ = true;
+    }
+    close(descriptor);
+#else
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        return std::nullopt;
+    }
+    file.buffer_.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    file.data_ = file.buffer_.data();
+    file.size_ = file.buffer_.size();
+#endif
+
+    return file;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      is_mapped_(std::exchange(other.is_mapped_, false)),
+      buffer_(std::move(other.buffer_)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Release();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        is_mapped_ = std::exchange(other.is_mapped_, false);
+        buffer_ = std::move(other.buffer_);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() { Release(); }
+
+void MappedFile::Release() {
+#ifdef ROUTER_SERIALIZATION_MMAP
+    if (is_mapped_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    is_mapped_ = false;
+    buffer_.clear();
+}
+
+}  // namespace serialization
+
+}  // namespace router
+
+}  // namespace transport_catalogue
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "domain.h"
+#include "transport_catalogue.h"
+
+namespace transport_catalogue {
+
+namespace router {
+
+namespace serialization {
+
+// file layout: FileHeader followed by the sections in the order of the header's counts,
+// every record is a multiple of 8 bytes, so all sections stay aligned inside a mapped file
+inline constexpr char kMagic[8] = {'T', 'R', 'R', 'O', 'U', 'T', 'E', 'R'};
+
+// bump on any change of the layout below
+inline constexpr uint32_t kVersion = 4;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t engine;
+    uint32_t graph_model;
+    // keeps the counts below aligned
+    uint32_t reserved;
+    uint64_t checksum;
+    uint64_t vertex_count;
+    uint64_t edge_count;
+    uint64_t stop_count;
+    uint64_t wait_edge_count;
+    uint64_t bus_edge_count;
+    // 0 when the engine keeps no precomputed table
+    uint64_t table_cell_count;
+    // bytes of the engine's own preprocessed data written after the table, e.g. a contraction hierarchy
+    uint64_t engine_data_size;
+};
+
+struct EdgeRecord {
+    uint64_t from;
+    uint64_t to;
+    double weight;
+};
+
+struct WaitEdgeRecord {
+    uint64_t edge_id;
+    uint64_t stop_index;
+    double time;
+};
+
+struct BusEdgeRecord {
+    uint64_t edge_id;
+    uint64_t bus_index;
+    int64_t span_count;
+    double time;
+};
+
+// FNV-1a over everything the routing graph is built from: stops, buses, distances along the buses
+// and the routing settings, a file with another checksum is stale
+uint64_t ComputeChecksum(const TransportCatalogue& catalogue, const RoutingSettings& settings);
+
+// read-only view of a whole file, memory-mapped where the platform allows it
+class MappedFile {
+public:
+    // returns nullopt if the file can't be opened
+    static std::optional<MappedFile> Open(const std::string& path);
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile();
+
+    const char* GetData() const { return data_; }
+
+    size_t GetSize() const { return size_; }
+
+private:
+    MappedFile() = default;
+
+    void Release();
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool is_mapped_ = false;
+    // used instead of a mapping where mmap isn't available
+    std::vector<char> buffer_;
+};
+
+// returns the records the cursor points to and moves it past them
+template <typename Record>
+const Record* ReadRecords(const char*& cursor, size_t count) {
+    const auto* records = reinterpret_cast<const Record*>(cursor);
+    cursor += sizeof(Record) * count;
+    return records;
+}
+
+template <typename Record>
+void WriteRecords(std::ostream& output, const Record* records, size_t count) {
+    output.write(reinterpret_cast<const char*>(records), static_cast<std::streamsize>(sizeof(Record) * count));
+}
+
+template <typename Record>
+void WriteRecords(std::ostream& output, const std::vector<Record>& records) {
+    WriteRecords(output, records.data(), records.size());
+}
+
+}  // namespace serialization
+
+}  // namespace router
+
+}  // namespace transport_catalogue
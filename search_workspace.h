@@ -0,0 +1,162 @@
+#pragma once
+
+#include "graph.h"
+#include "radix_heap.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// scratch state of one search: the weights, previous edges, bounds and flags of the vertexes and the queue;
+// every vertex entry is stamped with the generation of the search that wrote it, so a new search bumps
+// the generation instead of clearing O(V) entries, and the arrays and the queue keep their memory.
+// Unsigned integer weights keep the queue in a radix heap, which needs every pushed weight to be
+// no less than the last popped one
+template <typename Weight>
+class SearchWorkspace {
+public:
+    using QueueItem = std::pair<Weight, VertexId>;
+
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+    // starts a new search over vertex_count vertexes, nothing is reached, settled or marked
+    void Reset(size_t vertex_count);
+
+    bool IsReached(VertexId vertex) const { return reached_generations_[vertex] == generation_; }
+
+    // the weight and the edge a reached vertex was reached by, NO_EDGE for the start
+    Weight GetWeight(VertexId vertex) const { return weights_[vertex]; }
+    EdgeId GetPrevEdge(VertexId vertex) const { return prev_edges_[vertex]; }
+
+    void Reach(VertexId vertex, Weight weight, EdgeId prev_edge = NO_EDGE) {
+        reached_generations_[vertex] = generation_;
+        weights_[vertex] = weight;
+        prev_edges_[vertex] = prev_edge;
+    }
+
+    bool IsSettled(VertexId vertex) const { return settled_generations_[vertex] == generation_; }
+    void Settle(VertexId vertex) { settled_generations_[vertex] = generation_; }
+
+    // a flag for the search's own use, e.g. the targets
+    bool IsMarked(VertexId vertex) const { return marked_generations_[vertex] == generation_; }
+    void Mark(VertexId vertex) { marked_generations_[vertex] = generation_; }
+
+    // a lower bound of the rest of the route for guided searches, computed once per vertex
+    bool HasBound(VertexId vertex) const { return bound_generations_[vertex] == generation_; }
+    Weight GetBound(VertexId vertex) const { return bounds_[vertex]; }
+    void SetBound(VertexId vertex, Weight bound) {
+        bound_generations_[vertex] = generation_;
+        bounds_[vertex] = bound;
+    }
+
+    // a min-queue, a binary heap with the same order of equal items as std::priority_queue with std::greater
+    bool IsQueueEmpty() const;
+    const QueueItem& GetQueueTop();
+    void Push(Weight weight, VertexId vertex);
+    void Pop();
+    void ClearQueue();
+
+private:
+    using Generation = uint32_t;
+    static constexpr bool IS_RADIX_QUEUE = std::is_unsigned_v<Weight>;
+    using Queue = std::conditional_t<IS_RADIX_QUEUE, RadixHeap<Weight, VertexId>, std::vector<QueueItem>>;
+
+    Generation generation_ = 0;
+    std::vector<Generation> reached_generations_;
+    std::vector<Generation> settled_generations_;
+    std::vector<Generation> marked_generations_;
+    std::vector<Generation> bound_generations_;
+    std::vector<Weight> weights_;
+    std::vector<EdgeId> prev_edges_;
+    std::vector<Weight> bounds_;
+    Queue queue_;
+};
+
+template <typename Weight>
+void SearchWorkspace<Weight>::Reset(size_t vertex_count) {
+    ClearQueue();
+
+    // the stamps of a wrapped generation could match entries of old searches
+    if (generation_ == std::numeric_limits<Generation>::max()) {
+        generation_ = 0;
+        for (auto* generations : {&reached_generations_, &settled_generations_, &marked_generations_,
+                                  &bound_generations_}) {
+            std::fill(generations->begin(), generations->end(), 0);
+        }
+    }
+    ++generation_;
+
+    if (reached_generations_.size() < vertex_count) {
+        for (auto* generations : {&reached_generations_, &settled_generations_, &marked_generations_,
+                                  &bound_generations_}) {
+            generations->resize(vertex_count, 0);
+        }
+        weights_.resize(vertex_count);
+        prev_edges_.resize(vertex_count);
+        bounds_.resize(vertex_count);
+    }
+}
+
+template <typename Weight>
+bool SearchWorkspace<Weight>::IsQueueEmpty() const {
+    if constexpr (IS_RADIX_QUEUE) {
+        return queue_.IsEmpty();
+    } else {
+        return queue_.empty();
+    }
+}
+
+template <typename Weight>
+const typename SearchWorkspace<Weight>::QueueItem& SearchWorkspace<Weight>::GetQueueTop() {
+    if constexpr (IS_RADIX_QUEUE) {
+        return queue_.GetTop();
+    } else {
+        return queue_.front();
+    }
+}
+
+template <typename Weight>
+void SearchWorkspace<Weight>::Push(Weight weight, VertexId vertex) {
+    if constexpr (IS_RADIX_QUEUE) {
+        queue_.Push(weight, vertex);
+    } else {
+        queue_.push_back({weight, vertex});
+        std::push_heap(queue_.begin(), queue_.end(), std::greater<QueueItem>{});
+    }
+}
+
+template <typename Weight>
+void SearchWorkspace<Weight>::Pop() {
+    if constexpr (IS_RADIX_QUEUE) {
+        queue_.Pop();
+    } else {
+        std::pop_heap(queue_.begin(), queue_.end(), std::greater<QueueItem>{});
+        queue_.pop_back();
+    }
+}
+
+template <typename Weight>
+void SearchWorkspace<Weight>::ClearQueue() {
+    if constexpr (IS_RADIX_QUEUE) {
+        queue_.Clear();
+    } else {
+        queue_.clear();
+    }
+}
+
+// the workspaces of the calling thread: concurrent queries on different threads share nothing, and a thread
+// keeps the memory from one query to the next; the slots let one query run two searches at once,
+// but a search must not start another one on its own slot
+template <typename Weight>
+SearchWorkspace<Weight>& GetThreadSearchWorkspace(size_t slot = 0) {
+    thread_local SearchWorkspace<Weight> workspaces[2];
+    return workspaces[slot];
+}
+
+}  // namespace graph
@@ -0,0 +1,176 @@
+// the auto engine picks the first of the all-pairs table, the compact table and the contraction hierarchy whose
+// estimates it logs fit both budgets, else Dijkstra; the budgets of the routing settings are checked
+// g++ -std=c++17 -O2 -pthread -I.. auto_engine_test.cpp $(ls ../*.cpp | grep -v main.cpp)
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "json.h"
+#include "json_reader.h"
+#include "test_string.h"
+#include "transport_router.h"
+
+using namespace std::string_literals;
+using namespace transport_catalogue;
+
+namespace {
+
+using router::RoutingEngine;
+
+struct Estimate {
+    double bytes = 0.0;
+    double seconds = 0.0;
+};
+
+// the estimates of the engines in the order AUTO tries them
+struct Estimates {
+    Estimate all_pairs;
+    Estimate compact;
+    Estimate hierarchy;
+};
+
+// "<label> <bytes> bytes in about <seconds> s"
+Estimate ReadEstimate(const std::string& log, const std::string& label) {
+    const size_t position = log.find(label);
+    assert(position != std::string::npos);
+    std::istringstream input{log.substr(position + label.size())};
+    Estimate estimate;
+    std::string bytes_word;
+    std::string in_word;
+    std::string about_word;
+    input >> estimate.bytes >> bytes_word >> in_word >> about_word >> estimate.seconds;
+    assert(input && bytes_word == "bytes"s && about_word == "about"s);
+    return estimate;
+}
+
+Estimates ReadEstimates(const std::string& log) {
+    return {ReadEstimate(log, ", all-pairs table "s), ReadEstimate(log, ", compact all-pairs table "s),
+            ReadEstimate(log, ", contraction hierarchy "s)};
+}
+
+RoutingEngine GetExpectedEngine(const Estimates& estimates, double memory_budget, double build_time_budget) {
+    const auto is_within = [&](const Estimate& estimate) {
+        return estimate.bytes <= memory_budget && estimate.seconds <= build_time_budget;
+    };
+    if (is_within(estimates.all_pairs)) {
+        return RoutingEngine::ALL_PAIRS;
+    }
+    if (is_within(estimates.compact)) {
+        return RoutingEngine::COMPACT_ALL_PAIRS;
+    }
+    if (is_within(estimates.hierarchy)) {
+        return RoutingEngine::CONTRACTION_HIERARCHY;
+    }
+    return RoutingEngine::DIJKSTRA;
+}
+
+TransportCatalogue ReadCatalogue(const std::string& input, RoutingSettings& settings) {
+    std::istringstream input_stream{input};
+    json_reader::JsonReader reader;
+    reader.ReadJson(input_stream);
+    settings = json_reader::BuildRoutingSettings(reader.GetRoutingSettings());
+    return json_reader::ReadTransportCatalogue(reader.GetBaseRequests());
+}
+
+// the budgets fall just below and just above every estimate, the log prints six digits of them
+void TestChosenEngines(const std::string& input, router::RouteGraphModel model) {
+    RoutingSettings settings{};
+    const TransportCatalogue catalogue = ReadCatalogue(input, settings);
+
+    router::RouterOptions options;
+    options.engine = RoutingEngine::AUTO;
+    options.graph_model = model;
+    options.memory_budget = 0;
+    options.build_time_budget = 0.0;
+    std::ostringstream log;
+    options.log = &log;
+    assert(router::TransportRouter(catalogue, settings, options).GetEngine() == RoutingEngine::DIJKSTRA);
+    assert(log.str().find(": dijkstra\n"s) != std::string::npos);
+    const Estimates estimates = ReadEstimates(log.str());
+
+    std::vector<double> memory_budgets{0.0, 1e18};
+    std::vector<double> build_time_budgets{0.0, 1e9};
+    for (const Estimate& estimate : {estimates.all_pairs, estimates.compact, estimates.hierarchy}) {
+        for (const double factor : {0.99, 1.01}) {
+            memory_budgets.push_back(estimate.bytes * factor);
+            build_time_budgets.push_back(estimate.seconds * factor);
+        }
+    }
+
+    for (const double memory_budget : memory_budgets) {
+        for (const double build_time_budget : build_time_budgets) {
+            const RoutingEngine expected = GetExpectedEngine(estimates, memory_budget, build_time_budget);
+            // the tables of the large graphs take a while to build, so only the cheap choices are built there
+            if (estimates.all_pairs.seconds > 0.01 && expected != RoutingEngine::DIJKSTRA &&
+                expected != RoutingEngine::CONTRACTION_HIERARCHY) {
+                continue;
+            }
+            options.memory_budget = static_cast<size_t>(memory_budget);
+            options.build_time_budget = build_time_budget;
+            log.str(""s);
+            const router::TransportRouter transport_router(catalogue, settings, options);
+            assert(transport_router.GetEngine() == expected);
+            assert(log.str().find(": "s + std::string(router::GetRoutingEngineName(expected)) + "\n"s) !=
+                   std::string::npos);
+        }
+    }
+}
+
+void TestChosenEngines() {
+    for (const std::string* input : {&test_string, &test_string2, &test_string4}) {
+        TestChosenEngines(*input, router::RouteGraphModel::STOP_TO_STOP);
+        TestChosenEngines(*input, router::RouteGraphModel::ON_BOARD);
+    }
+}
+
+json::Dict MakeSettings(const std::string& key, json::Node value) {
+    return json::Dict{{key, std::move(value)}};
+}
+
+bool IsRejected(const json::Dict& routing_settings) {
+    try {
+        json_reader::BuildRouterOptions(routing_settings, {});
+    } catch (const std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+void TestRouterOptions() {
+    assert(json_reader::BuildRouterOptions(MakeSettings("engine"s, "auto"s), {}).engine == RoutingEngine::AUTO);
+    assert(IsRejected(MakeSettings("engine"s, "fastest"s)));
+
+    assert(json_reader::BuildRouterOptions(MakeSettings("memory_budget_mb"s, 3), {}).memory_budget == 3u << 20);
+    assert(json_reader::BuildRouterOptions(MakeSettings("memory_budget_mb"s, 0.5), {}).memory_budget == 1u << 19);
+    assert(json_reader::BuildRouterOptions(MakeSettings("memory_budget_mb"s, 0), {}).memory_budget == 0);
+    assert(json_reader::BuildRouterOptions(MakeSettings("memory_budget_mb"s, 1e300), {}).memory_budget ==
+           std::numeric_limits<size_t>::max());
+    for (const double memory_budget_mb : {-1.0, -1e300, std::numeric_limits<double>::infinity(),
+                                          -std::numeric_limits<double>::infinity(),
+                                          std::numeric_limits<double>::quiet_NaN()}) {
+        assert(IsRejected(MakeSettings("memory_budget_mb"s, memory_budget_mb)));
+    }
+    assert(IsRejected(MakeSettings("memory_budget_mb"s, -1)));
+
+    assert(json_reader::BuildRouterOptions(MakeSettings("build_time_budget"s, 2.5), {}).build_time_budget == 2.5);
+    assert(IsRejected(MakeSettings("build_time_budget"s, -1.0)));
+    assert(IsRejected(MakeSettings("build_time_budget"s, std::numeric_limits<double>::quiet_NaN())));
+
+    assert(json_reader::BuildRouterOptions(MakeSettings("thread_count"s, 4), {}).thread_count == 4);
+    assert(IsRejected(MakeSettings("thread_count"s, -1)));
+}
+
+}  // namespace
+
+int main() {
+    TestChosenEngines();
+    TestRouterOptions();
+    std::cout << "auto_engine_test OK"s << std::endl;
+}
@@ -0,0 +1,148 @@
+// a bounded search reaches exactly the vertexes graph::Router finds within the budget of the start, along
+// and against the edges, and an isochrone of the transport router holds exactly the stops its routes reach
+// within the time
+// g++ -std=c++17 -O2 -pthread -I.. bounded_search_test.cpp $(ls ../*.cpp | grep -v main.cpp)
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bounded_search.h"
+#include "csr_graph.h"
+#include "json_reader.h"
+#include "router.h"
+#include "test_graphs.h"
+#include "test_string.h"
+#include "transport_router.h"
+
+using namespace std::string_literals;
+using namespace transport_catalogue;
+
+namespace {
+
+using BoundedSearch = graph::BoundedSearch<double>;
+using Direction = BoundedSearch::Direction;
+
+// the vertexes of the search come in the order of their weights, once each, and are those the reference
+// routes to (or from, backwards) within the budget, by the same weights
+void CheckSearch(const tests::Graph& graph, const graph::Router<double>& reference, const BoundedSearch& search,
+                 graph::VertexId start, double max_weight, Direction direction) {
+    const auto reached = search.Search(start, max_weight, direction);
+    std::vector<bool> is_reached(graph.GetVertexCount(), false);
+    for (size_t index = 0; index < reached.size(); ++index) {
+        assert(!is_reached[reached[index].vertex]);
+        is_reached[reached[index].vertex] = true;
+        assert(index == 0 || reached[index - 1].weight <= reached[index].weight);
+    }
+    assert(max_weight < 0.0 || (!reached.empty() && reached[0].vertex == start && reached[0].weight == 0.0));
+
+    std::map<graph::VertexId, double> weights;
+    for (const auto& [vertex, weight] : reached) {
+        weights[vertex] = weight;
+    }
+    for (graph::VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+        const auto route = direction == Direction::FORWARD ? reference.BuildRoute(start, vertex)
+                                                           : reference.BuildRoute(vertex, start);
+        const bool is_within = route && route->weight <= max_weight;
+        assert(is_reached[vertex] == is_within);
+        if (is_within) {
+            assert(weights[vertex] == route->weight);
+        }
+    }
+}
+
+// the budgets fall on the weights of some routes, so the vertexes right at the budget are checked too
+void TestBoundedSearch() {
+    std::mt19937 random(59);
+    std::vector<tests::Graph> graphs;
+    for (size_t vertex_count : {1, 2, 10, 50, 120}) {
+        for (size_t edge_factor : {0, 1, 3}) {
+            graphs.push_back(tests::MakeRandomGraph(vertex_count, vertex_count * edge_factor, random));
+        }
+    }
+    graphs.push_back(tests::MakeGridGraph(8, random));
+
+    for (const tests::Graph& graph : graphs) {
+        const graph::Router<double> reference(graph);
+        const graph::CsrGraph<double> forward_graph(graph, Direction::FORWARD);
+        const graph::CsrGraph<double> backward_graph(graph, Direction::BACKWARD);
+        const BoundedSearch search(forward_graph, backward_graph);
+        std::uniform_int_distribution<graph::VertexId> any_vertex(0, graph.GetVertexCount() - 1);
+        for (graph::VertexId start = 0; start < graph.GetVertexCount(); ++start) {
+            std::vector<double> max_weights{-1.0, 0.0, 2.5, 1e9};
+            for (int i = 0; i < 3; ++i) {
+                if (const auto route = reference.BuildRoute(start, any_vertex(random))) {
+                    max_weights.push_back(route->weight);
+                }
+            }
+            for (const double max_weight : max_weights) {
+                CheckSearch(graph, reference, search, start, max_weight, Direction::FORWARD);
+                CheckSearch(graph, reference, search, start, max_weight, Direction::BACKWARD);
+            }
+        }
+    }
+}
+
+TransportCatalogue ReadCatalogue(const std::string& input, RoutingSettings& settings) {
+    std::istringstream input_stream{input};
+    json_reader::JsonReader reader;
+    reader.ReadJson(input_stream);
+    settings = json_reader::BuildRoutingSettings(reader.GetRoutingSettings());
+    return json_reader::ReadTransportCatalogue(reader.GetBaseRequests());
+}
+
+// the isochrone of a stop holds the stops whose routes from it (or to it) take at most the time; the times
+// of the routes are summed in another order than the search sums them, so the stops right at the time
+// may fall either way
+void TestIsochrones() {
+    using IsochroneDirection = router::TransportRouter::IsochroneDirection;
+    constexpr double kTolerance = 1e-9;
+
+    for (const std::string* input : {&test_string, &test_string2, &test_string3}) {
+        RoutingSettings settings{};
+        const TransportCatalogue catalogue = ReadCatalogue(*input, settings);
+        for (const auto model : {router::RouteGraphModel::STOP_TO_STOP, router::RouteGraphModel::ON_BOARD}) {
+            router::RouterOptions options;
+            options.graph_model = model;
+            const router::TransportRouter transport_router(catalogue, settings, options);
+            for (const Stop& stop : catalogue.GetAllStops()) {
+                for (const double max_time : {0.0, 10.0, 30.0, 1e9}) {
+                    for (const auto direction : {IsochroneDirection::FROM_STOP, IsochroneDirection::TO_STOP}) {
+                        const auto isochrone = transport_router.GetIsochrone(&stop, max_time, direction);
+                        std::map<std::string_view, double> times;
+                        for (const auto& [stop_name, time] : isochrone) {
+                            assert(times.count(stop_name) == 0);
+                            times[stop_name] = time;
+                        }
+                        for (const Stop& other_stop : catalogue.GetAllStops()) {
+                            const auto route = direction == IsochroneDirection::FROM_STOP
+                                                   ? transport_router.GetRouteInfo(&stop, &other_stop)
+                                                   : transport_router.GetRouteInfo(&other_stop, &stop);
+                            const auto time = times.find(other_stop.name);
+                            if (time != times.end()) {
+                                assert(route && std::abs(route->first - time->second) <= kTolerance);
+                                assert(time->second <= max_time);
+                            } else {
+                                assert(!route || route->first > max_time - kTolerance);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestBoundedSearch();
+    TestIsochrones();
+    std::cout << "bounded_search_test OK"s << std::endl;
+}
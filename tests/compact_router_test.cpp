@@ -0,0 +1,116 @@
+// the compact table answers like graph::Router in cells of both sizes, also loaded from a stream,
+// and tables whose edges don't walk back to the start of the route are rejected
+// g++ -std=c++17 -O2 -pthread -I.. compact_router_test.cpp ../thread_pool.cpp ../min_plus.cpp
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "compact_router.h"
+#include "test_graphs.h"
+#include "thread_pool.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+using CompactRouter = graph::CompactRouter<double>;
+
+// the vertex and cell counts in 64 bits, then the cells
+constexpr size_t kHeaderSize = 2 * sizeof(uint64_t);
+
+std::string SaveTable(const CompactRouter& router) {
+    std::ostringstream output;
+    router.Save(output);
+    return output.str();
+}
+
+bool IsRejected(const tests::Graph& graph, const std::string& table) {
+    std::istringstream input{table};
+    try {
+        CompactRouter router(graph, input);
+    } catch (const std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+void CheckSameRoutes(const tests::Graph& graph, size_t cell_size, concurrency::ThreadPool& thread_pool) {
+    const graph::Router<double> reference(graph);
+    const CompactRouter router(graph, &thread_pool);
+    assert(router.GetCellSize() == cell_size);
+    tests::CheckSameRoutes(graph, reference, router);
+    tests::CheckSameRoutes(graph, reference, CompactRouter(graph));
+
+    std::istringstream input{SaveTable(router)};
+    const CompactRouter loaded_router(graph, input);
+    assert(loaded_router.GetCellSize() == cell_size);
+    tests::CheckSameRoutes(graph, reference, loaded_router);
+}
+
+void TestRandomGraphs() {
+    std::mt19937 random(31);
+    concurrency::ThreadPool thread_pool(2);
+    for (size_t vertex_count : {1, 2, 10, 50, 200}) {
+        for (size_t edge_factor : {0, 1, 3}) {
+            CheckSameRoutes(tests::MakeRandomGraph(vertex_count, vertex_count * edge_factor, random),
+                            sizeof(uint16_t), thread_pool);
+        }
+    }
+    // edge ids past 16 bits
+    CheckSameRoutes(tests::MakeRandomGraph(40, 70000, random), sizeof(uint32_t), thread_pool);
+}
+
+void OverwriteCell(std::string& table, size_t size, graph::VertexId from, graph::VertexId to, uint16_t edge_id) {
+    const size_t position = kHeaderSize + sizeof(uint16_t) * (from * size * size + to);
+    std::memcpy(table.data() + position, &edge_id, sizeof(edge_id));
+}
+
+// the first row of a grid: the edges 0 and 1 join the vertexes 0 and 1, the edges 4 and 5 join 1 and 2
+void TestCorruptedTable() {
+    std::mt19937 random(37);
+    const size_t size = 5;
+    tests::Graph graph = tests::MakeGridGraph(size, random);
+    const std::string table = SaveTable(CompactRouter(graph));
+
+    assert(!IsRejected(graph, table));
+    assert(IsRejected(graph, ""s));
+    assert(IsRejected(graph, table.substr(0, table.size() - 1)));
+    assert(IsRejected(tests::Graph(size * size), table));
+
+    std::string corrupted = table;
+    OverwriteCell(corrupted, size, 0, 1, static_cast<uint16_t>(graph.GetEdgeCount()));
+    assert(IsRejected(graph, corrupted));
+
+    // a route without edges
+    corrupted = table;
+    OverwriteCell(corrupted, size, 0, 0, 1);
+    assert(IsRejected(graph, corrupted));
+
+    // an edge into another vertex
+    corrupted = table;
+    OverwriteCell(corrupted, size, 0, 1, 4);
+    assert(IsRejected(graph, corrupted));
+
+    // the vertexes 1 and 2 reached from each other
+    corrupted = table;
+    OverwriteCell(corrupted, size, 0, 1, 5);
+    OverwriteCell(corrupted, size, 0, 2, 4);
+    assert(IsRejected(graph, corrupted));
+
+    graph.RemoveEdge(0);
+    assert(IsRejected(graph, table));
+}
+
+}  // namespace
+
+int main() {
+    TestRandomGraphs();
+    TestCorruptedTable();
+    std::cout << "compact_router_test OK"s << std::endl;
+}
@@ -0,0 +1,152 @@
+// a contraction hierarchy loaded from a stream answers like graph::Router, and hierarchies whose shortcuts
+// don't join their halves are rejected
+// g++ -std=c++17 -O2 -pthread -I.. contraction_hierarchy_test.cpp ../thread_pool.cpp ../min_plus.cpp
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "contraction_hierarchy_router.h"
+#include "test_graphs.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+using HierarchyRouter = graph::ContractionHierarchyRouter<double>;
+
+// the vertex, original edge and edge counts in 64 bits, then the ranks in 32 bits, then the edges:
+// from and to in 32 bits, the weight, the two halves in 32 bits
+constexpr size_t kHeaderSize = 3 * sizeof(uint64_t);
+constexpr size_t kEdgeSize = 24;
+constexpr size_t kToOffset = 4;
+constexpr size_t kWeightOffset = 8;
+constexpr size_t kFirstHalfOffset = 16;
+constexpr size_t kSecondHalfOffset = 20;
+constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+std::string SaveHierarchy(const HierarchyRouter& router) {
+    std::ostringstream output;
+    router.Save(output);
+    return output.str();
+}
+
+bool IsRejected(const tests::Graph& graph, const std::string& hierarchy) {
+    std::istringstream input{hierarchy};
+    try {
+        HierarchyRouter router(graph, input);
+    } catch (const std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+template <typename Value>
+Value Read(const std::string& data, size_t position) {
+    Value value{};
+    std::memcpy(&value, data.data() + position, sizeof(value));
+    return value;
+}
+
+template <typename Value>
+void Overwrite(std::string& data, size_t position, Value value) {
+    std::memcpy(data.data() + position, &value, sizeof(value));
+}
+
+void TestSavedHierarchies() {
+    std::mt19937 random(47);
+    for (size_t vertex_count : {1, 2, 10, 50, 200}) {
+        for (size_t edge_factor : {0, 1, 3}) {
+            tests::Graph graph = tests::MakeRandomGraph(vertex_count, vertex_count * edge_factor, random);
+            const graph::Router<double> reference(graph);
+            std::istringstream input{SaveHierarchy(HierarchyRouter(graph))};
+            tests::CheckSameRoutes(graph, reference, HierarchyRouter(graph, input));
+        }
+    }
+}
+
+void TestCorruptedHierarchies() {
+    std::mt19937 random(53);
+    const tests::Graph graph = tests::MakeGridGraph(6, random);
+    const std::string hierarchy = SaveHierarchy(HierarchyRouter(graph));
+    const size_t vertex_count = graph.GetVertexCount();
+    const size_t original_edge_count = graph.GetEdgeCount();
+    const size_t edge_count = Read<uint64_t>(hierarchy, 2 * sizeof(uint64_t));
+    const size_t ranks_position = kHeaderSize;
+    const size_t edges_position = ranks_position + sizeof(uint32_t) * vertex_count;
+    assert(edge_count > original_edge_count);
+
+    assert(!IsRejected(graph, hierarchy));
+    assert(IsRejected(graph, ""s));
+    assert(IsRejected(graph, hierarchy.substr(0, hierarchy.size() - 1)));
+
+    // edge counts far beyond the input are rejected before anything is allocated for them
+    for (const uint64_t count : {uint64_t{1} << 31, uint64_t{1} << 40, ~uint64_t{0}}) {
+        std::string corrupted = hierarchy;
+        Overwrite(corrupted, 2 * sizeof(uint64_t), count);
+        assert(IsRejected(graph, corrupted));
+    }
+
+    // the ranks must be a permutation of the vertexes
+    std::string corrupted = hierarchy;
+    Overwrite(corrupted, ranks_position + sizeof(uint32_t), Read<uint32_t>(hierarchy, ranks_position));
+    assert(IsRejected(graph, corrupted));
+
+    // an original edge of another weight or into another vertex
+    corrupted = hierarchy;
+    Overwrite(corrupted, edges_position + kWeightOffset,
+              Read<double>(hierarchy, edges_position + kWeightOffset) + 1.0);
+    assert(IsRejected(graph, corrupted));
+
+    corrupted = hierarchy;
+    const uint32_t to = Read<uint32_t>(hierarchy, edges_position + kToOffset);
+    Overwrite(corrupted, edges_position + kToOffset, static_cast<uint32_t>((to + 1) % vertex_count));
+    assert(IsRejected(graph, corrupted));
+
+    // the first shortcut: of another weight, with a half that doesn't join the other one, with itself
+    // or no edge as a half, and an original edge made a shortcut
+    const size_t shortcut_position = edges_position + kEdgeSize * original_edge_count;
+    corrupted = hierarchy;
+    Overwrite(corrupted, shortcut_position + kWeightOffset,
+              Read<double>(hierarchy, shortcut_position + kWeightOffset) + 0.25);
+    assert(IsRejected(graph, corrupted));
+
+    const uint32_t first_half = Read<uint32_t>(hierarchy, shortcut_position + kFirstHalfOffset);
+    const uint32_t second_half = Read<uint32_t>(hierarchy, shortcut_position + kSecondHalfOffset);
+    for (const uint32_t half : {second_half, static_cast<uint32_t>(original_edge_count), kNone}) {
+        corrupted = hierarchy;
+        Overwrite(corrupted, shortcut_position + kFirstHalfOffset, half);
+        assert(IsRejected(graph, corrupted));
+    }
+    corrupted = hierarchy;
+    Overwrite(corrupted, shortcut_position + kSecondHalfOffset, first_half);
+    assert(IsRejected(graph, corrupted));
+
+    corrupted = hierarchy;
+    Overwrite(corrupted, edges_position + kFirstHalfOffset, uint32_t{0});
+    assert(IsRejected(graph, corrupted));
+
+    // the vertex the halves join ranked above an end of the shortcut
+    const uint32_t middle = Read<uint32_t>(hierarchy, edges_position + kEdgeSize * first_half + kToOffset);
+    const uint32_t from = Read<uint32_t>(hierarchy, shortcut_position);
+    corrupted = hierarchy;
+    Overwrite(corrupted, ranks_position + sizeof(uint32_t) * middle,
+              Read<uint32_t>(hierarchy, ranks_position + sizeof(uint32_t) * from));
+    Overwrite(corrupted, ranks_position + sizeof(uint32_t) * from,
+              Read<uint32_t>(hierarchy, ranks_position + sizeof(uint32_t) * middle));
+    assert(IsRejected(graph, corrupted));
+}
+
+}  // namespace
+
+int main() {
+    TestSavedHierarchies();
+    TestCorruptedHierarchies();
+    std::cout << "contraction_hierarchy_test OK"s << std::endl;
+}
@@ -0,0 +1,164 @@
+// every engine finds routes of the same weight as graph::Router
+// g++ -std=c++17 -O2 -pthread -I.. engine_equivalence_test.cpp $(ls ../*.cpp | grep -v main.cpp)
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "astar_router.h"
+#include "bidirectional_dijkstra_router.h"
+#include "compact_router.h"
+#include "contraction_hierarchy_router.h"
+#include "dijkstra_router.h"
+#include "fixed_point_router.h"
+#include "hub_labeling_router.h"
+#include "json_reader.h"
+#include "multilevel_overlay_router.h"
+#include "test_graphs.h"
+#include "test_string.h"
+#include "thread_pool.h"
+#include "transport_router.h"
+
+using namespace std::string_literals;
+using namespace transport_catalogue;
+
+namespace {
+
+constexpr size_t kMaxOnBoardStopCount = 50;
+
+void TestRandomGraphs() {
+    std::mt19937 random(7);
+    concurrency::ThreadPool thread_pool(2);
+    for (size_t vertex_count : {0, 1, 2, 5, 20, 60}) {
+        for (size_t edge_factor : {0, 1, 3}) {
+            const tests::Graph graph = tests::MakeRandomGraph(vertex_count, vertex_count * edge_factor, random);
+            const graph::Router<double> reference(graph);
+
+            tests::CheckSameRoutes(graph, reference, graph::Router<double>(graph, &thread_pool));
+            tests::CheckSameRoutes(graph, reference, graph::DijkstraRouter<double>(graph));
+            tests::CheckSameRoutes(graph, reference,
+                                   graph::AStarRouter<double>(graph, [](graph::VertexId, graph::VertexId) {
+                                       return 0.0;
+                                   }));
+            tests::CheckSameRoutes(graph, reference, graph::BidirectionalDijkstraRouter<double>(graph));
+            tests::CheckSameRoutes(graph, reference, graph::FixedPointRouter<double>(graph, 0.25));
+            tests::CheckSameRoutes(graph, reference, graph::ContractionHierarchyRouter<double>(graph));
+            tests::CheckSameRoutes(graph, reference,
+                                   graph::ContractionHierarchyRouter<double>(graph, &thread_pool));
+            tests::CheckSameRoutes(graph, reference, graph::HubLabelingRouter<double>(graph));
+            tests::CheckSameRoutes(graph, reference, graph::MultilevelOverlayRouter<double>(graph));
+            tests::CheckSameRoutes(graph, reference, graph::CompactRouter<double>(graph));
+        }
+    }
+}
+
+// over weights that aren't whole steps the fixed-point engine weighs the route it finds by the original weights,
+// which is heavier than the lightest route by at most half a step per edge of the two routes
+void TestFixedPointRounding() {
+    std::mt19937 random(73);
+    std::uniform_real_distribution<double> any_weight(0.0, 10.0);
+    for (size_t vertex_count : {2, 5, 20, 60}) {
+        tests::Graph graph = tests::MakeRandomGraph(vertex_count, vertex_count * 3, random);
+        for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            graph.SetEdgeWeight(edge_id, any_weight(random));
+        }
+        const graph::Router<double> reference(graph);
+        for (const double unit : {0.3, 1e-3}) {
+            const graph::FixedPointRouter<double> engine(graph, unit);
+            for (graph::VertexId from = 0; from < vertex_count; ++from) {
+                for (graph::VertexId to = 0; to < vertex_count; ++to) {
+                    const auto expected = reference.BuildRoute(from, to);
+                    const auto route = engine.BuildRoute(from, to);
+                    assert(route.has_value() == expected.has_value());
+                    if (!route) {
+                        continue;
+                    }
+                    tests::CheckRoutePath(graph, from, to, *route, 1e-9);
+                    const double max_deviation = (route->edges.size() + expected->edges.size()) * unit / 2;
+                    assert(route->weight >= expected->weight - 1e-9);
+                    assert(route->weight <= expected->weight + max_deviation + 1e-9);
+                }
+            }
+        }
+    }
+}
+
+TransportCatalogue ReadCatalogue(const std::string& input, RoutingSettings& settings) {
+    std::istringstream input_stream{input};
+    json_reader::JsonReader reader;
+    reader.ReadJson(input_stream);
+    settings = json_reader::BuildRoutingSettings(reader.GetRoutingSettings());
+    return json_reader::ReadTransportCatalogue(reader.GetBaseRequests());
+}
+
+// the fixed-point engine rounds every edge to a step of kFixedPointUnit, half a step off at most, and may pick
+// a route slower by that much per edge of it and of the fastest one: 0.05 minutes covers 60 edges of them
+double GetTolerance(router::RoutingEngine engine) {
+    return engine == router::RoutingEngine::FIXED_POINT_DIJKSTRA ? 0.05 : 1e-6;
+}
+
+void TestCatalogues() {
+    const std::vector<router::RoutingEngine> engines{
+        router::RoutingEngine::DIJKSTRA,
+        router::RoutingEngine::CONTRACTION_HIERARCHY,
+        router::RoutingEngine::ASTAR,
+        router::RoutingEngine::BIDIRECTIONAL_DIJKSTRA,
+        router::RoutingEngine::FIXED_POINT_DIJKSTRA,
+        router::RoutingEngine::HUB_LABELING,
+        router::RoutingEngine::MULTILEVEL_OVERLAY,
+        router::RoutingEngine::COMPACT_ALL_PAIRS,
+        router::RoutingEngine::AUTO,
+    };
+
+    for (const std::string* input : {&test_string, &test_string2, &test_string3, &test_string4}) {
+        RoutingSettings settings{};
+        const TransportCatalogue catalogue = ReadCatalogue(*input, settings);
+        std::vector<StopPtr> stops;
+        for (const Stop& stop : catalogue.GetAllStops()) {
+            stops.push_back(&stop);
+        }
+
+        for (auto model : {router::RouteGraphModel::STOP_TO_STOP, router::RouteGraphModel::ON_BOARD}) {
+            // the all-pairs reference over the on-board graph of the largest catalogue takes minutes
+            if (model == router::RouteGraphModel::ON_BOARD && stops.size() > kMaxOnBoardStopCount) {
+                continue;
+            }
+            router::RouterOptions options;
+            options.graph_model = model;
+            options.route_cache_capacity = 0;
+            const router::TransportRouter reference(catalogue, settings, options);
+            const auto expected = reference.GetRouteMatrix(stops, stops, false);
+
+            for (router::RoutingEngine engine : engines) {
+                options.engine = engine;
+                const router::TransportRouter transport_router(catalogue, settings, options);
+                const auto matrix = transport_router.GetRouteMatrix(stops, stops, false);
+                for (size_t from = 0; from < stops.size(); ++from) {
+                    for (size_t to = 0; to < stops.size(); ++to) {
+                        const auto route = transport_router.GetRouteInfo(stops[from], stops[to]);
+                        assert(route.has_value() == expected[from][to].has_value());
+                        assert(matrix[from][to].has_value() == expected[from][to].has_value());
+                        if (route) {
+                            assert(std::abs(route->first - expected[from][to]->first) <= GetTolerance(engine));
+                            assert(std::abs(matrix[from][to]->first - expected[from][to]->first) <=
+                                   GetTolerance(engine));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestRandomGraphs();
+    TestFixedPointRounding();
+    TestCatalogues();
+    std::cout << "engine_equivalence_test OK"s << std::endl;
+}
@@ -0,0 +1,253 @@
+// hub labels answer like graph::Router, also loaded from a stream, and corrupted labels are rejected
+// g++ -std=c++17 -O2 -pthread -I.. hub_labeling_test.cpp ../thread_pool.cpp ../min_plus.cpp
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "hub_labeling_router.h"
+#include "test_graphs.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+using HubLabelingRouter = graph::HubLabelingRouter<double>;
+
+std::string SaveLabels(const HubLabelingRouter& router) {
+    std::ostringstream output;
+    router.Save(output);
+    return output.str();
+}
+
+bool IsRejected(const tests::Graph& graph, const std::string& labels) {
+    std::istringstream input{labels};
+    try {
+        HubLabelingRouter router(graph, input);
+    } catch (const std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+uint32_t ReadIndex(const std::string& labels, size_t position) {
+    uint32_t value = 0;
+    std::memcpy(&value, labels.data() + position, sizeof(value));
+    return value;
+}
+
+void OverwriteIndex(std::string& labels, size_t position, uint32_t value) {
+    std::memcpy(labels.data() + position, &value, sizeof(value));
+}
+
+constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+constexpr size_t kRanksPosition = 4 * sizeof(uint64_t);
+
+// where the arrays of the out (0) and in (1) labels start: the offsets, the hubs, the parent edges, the weights
+struct LabelsLayout {
+    std::array<size_t, 2> offsets;
+    std::array<size_t, 2> hubs;
+    std::array<size_t, 2> parent_edges;
+    std::array<size_t, 2> weights;
+};
+
+LabelsLayout GetLayout(const std::string& labels, size_t vertex_count) {
+    LabelsLayout layout{};
+    size_t position = kRanksPosition + sizeof(uint32_t) * vertex_count;
+    for (const size_t side : {0, 1}) {
+        uint64_t entry_count = 0;
+        std::memcpy(&entry_count, labels.data() + 2 * sizeof(uint64_t) + side * sizeof(uint64_t), sizeof(uint64_t));
+        layout.offsets[side] = position;
+        layout.hubs[side] = layout.offsets[side] + sizeof(uint32_t) * (vertex_count + 1);
+        layout.parent_edges[side] = layout.hubs[side] + sizeof(uint32_t) * entry_count;
+        layout.weights[side] = layout.parent_edges[side] + sizeof(uint32_t) * entry_count;
+        position = layout.weights[side] + sizeof(double) * entry_count;
+    }
+    return layout;
+}
+
+// the index of the entry of the hub in a label of the vertex
+uint32_t GetEntryIndex(const std::string& labels, const LabelsLayout& layout, size_t side, uint32_t vertex,
+                       uint32_t hub) {
+    const uint32_t begin = ReadIndex(labels, layout.offsets[side] + sizeof(uint32_t) * vertex);
+    const uint32_t end = ReadIndex(labels, layout.offsets[side] + sizeof(uint32_t) * (vertex + 1));
+    for (uint32_t index = begin; index < end; ++index) {
+        if (ReadIndex(labels, layout.hubs[side] + sizeof(uint32_t) * index) == hub) {
+            return index;
+        }
+    }
+    assert(false);
+    return kNone;
+}
+
+uint32_t GetRank(const std::string& labels, size_t vertex_count, uint32_t vertex) {
+    for (uint32_t rank = 0; rank < vertex_count; ++rank) {
+        if (ReadIndex(labels, kRanksPosition + sizeof(uint32_t) * rank) == vertex) {
+            return rank;
+        }
+    }
+    assert(false);
+    return kNone;
+}
+
+void TestRandomGraphs() {
+    std::mt19937 random(13);
+    for (size_t vertex_count : {1, 2, 10, 50, 200}) {
+        for (size_t edge_factor : {1, 2, 4}) {
+            const tests::Graph graph = tests::MakeRandomGraph(vertex_count, vertex_count * edge_factor, random);
+            const graph::Router<double> reference(graph);
+            const HubLabelingRouter router(graph);
+            tests::CheckSameRoutes(graph, reference, router);
+
+            std::istringstream input{SaveLabels(router)};
+            tests::CheckSameRoutes(graph, reference, HubLabelingRouter(graph, input));
+        }
+    }
+}
+
+// the header holds the vertex, edge and two entry counts in 64 bits, then come the ranks
+// and the offsets of the out labels in 32 bits, then the hubs of the out labels
+void TestCorruptedLabels() {
+    std::mt19937 random(17);
+    const size_t vertex_count = 30;
+    tests::Graph graph = tests::MakeRandomGraph(vertex_count, vertex_count * 3, random);
+    const std::string labels = SaveLabels(HubLabelingRouter(graph));
+    const size_t ranks_position = kRanksPosition;
+    const size_t hubs_position = ranks_position + sizeof(uint32_t) * (vertex_count + vertex_count + 1);
+
+    assert(!IsRejected(graph, labels));
+    assert(IsRejected(graph, ""s));
+    assert(IsRejected(graph, labels.substr(0, labels.size() / 2)));
+    assert(IsRejected(graph, labels.substr(0, labels.size() - 1)));
+
+    std::string corrupted = labels;
+    OverwriteIndex(corrupted, ranks_position, static_cast<uint32_t>(vertex_count));
+    assert(IsRejected(graph, corrupted));
+
+    // the ranks must be a permutation of the vertexes
+    corrupted = labels;
+    OverwriteIndex(corrupted, ranks_position + sizeof(uint32_t), ReadIndex(labels, ranks_position));
+    assert(IsRejected(graph, corrupted));
+
+    corrupted = labels;
+    OverwriteIndex(corrupted, hubs_position, static_cast<uint32_t>(vertex_count));
+    assert(IsRejected(graph, corrupted));
+
+    // entry counts far beyond the input are rejected before anything is allocated for them
+    for (const uint64_t entry_count : {uint64_t{1} << 31, uint64_t{1} << 40, ~uint64_t{0}}) {
+        corrupted = labels;
+        std::memcpy(corrupted.data() + 2 * sizeof(uint64_t), &entry_count, sizeof(entry_count));
+        assert(IsRejected(graph, corrupted));
+    }
+
+    // the hubs of a label must ascend, a label of two entries gets the first hub twice
+    const uint32_t first_label_size = ReadIndex(labels, ranks_position + sizeof(uint32_t) * (vertex_count + 1));
+    if (first_label_size > 1) {
+        corrupted = labels;
+        OverwriteIndex(corrupted, hubs_position + sizeof(uint32_t), ReadIndex(labels, hubs_position));
+        assert(IsRejected(graph, corrupted));
+    }
+
+    // labels of another graph
+    graph.AddEdge({0, 1, 1.0});
+    assert(IsRejected(graph, labels));
+}
+
+// the parent edges of every entry must walk to the entry of its hub, queries follow them without checks
+void TestCorruptedParents() {
+    std::mt19937 random(19);
+    const size_t vertex_count = 30;
+    const tests::Graph graph = tests::MakeRandomGraph(vertex_count, vertex_count * 3, random);
+    const std::string labels = SaveLabels(HubLabelingRouter(graph));
+    const LabelsLayout layout = GetLayout(labels, vertex_count);
+
+    for (const size_t side : {0, 1}) {
+        // the first entry of the side with a parent edge, the entries without one are the hubs' own
+        uint32_t vertex = 0;
+        uint32_t index = ReadIndex(labels, layout.offsets[side]);
+        while (ReadIndex(labels, layout.parent_edges[side] + sizeof(uint32_t) * index) == kNone) {
+            ++index;
+            while (ReadIndex(labels, layout.offsets[side] + sizeof(uint32_t) * (vertex + 1)) <= index) {
+                ++vertex;
+            }
+        }
+        const size_t parent_position = layout.parent_edges[side] + sizeof(uint32_t) * index;
+        const uint32_t parent_edge = ReadIndex(labels, parent_position);
+
+        std::string corrupted = labels;
+        OverwriteIndex(corrupted, parent_position, kNone);
+        assert(IsRejected(graph, corrupted));
+
+        // an edge that doesn't leave (or enter) the vertex of the entry
+        for (uint32_t edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            const auto& edge = graph.GetEdge(edge_id);
+            if ((side == 0 ? edge.from : edge.to) != vertex) {
+                corrupted = labels;
+                OverwriteIndex(corrupted, parent_position, edge_id);
+                assert(IsRejected(graph, corrupted));
+                break;
+            }
+        }
+
+        // the hub's own entry must have no parent edge
+        const uint32_t hub = ReadIndex(labels, layout.hubs[side] + sizeof(uint32_t) * index);
+        const uint32_t hub_vertex = ReadIndex(labels, kRanksPosition + sizeof(uint32_t) * hub);
+        corrupted = labels;
+        OverwriteIndex(corrupted,
+                       layout.parent_edges[side] +
+                           sizeof(uint32_t) * GetEntryIndex(labels, layout, side, hub_vertex, hub),
+                       parent_edge);
+        assert(IsRejected(graph, corrupted));
+
+        // a weight the parent edge doesn't make
+        corrupted = labels;
+        const double weight = 1e6;
+        std::memcpy(corrupted.data() + layout.weights[side] + sizeof(double) * index, &weight, sizeof(weight));
+        assert(IsRejected(graph, corrupted));
+    }
+
+    // 1 and 2 reach the hub 0 with the same weight through each other's zero edges, so a parent edge
+    // of 1 turned towards 2 passes every local check and only the cycle 1 -> 2 -> 1 is wrong
+    tests::Graph cycle_graph(3);
+    cycle_graph.AddEdge({0, 0, 1.0});
+    cycle_graph.AddEdge({1, 0, 1.0});
+    const graph::EdgeId edge_1_2 = cycle_graph.AddEdge({1, 2, 0.0});
+    cycle_graph.AddEdge({2, 1, 0.0});
+    cycle_graph.AddEdge({2, 0, 5.0});
+    const std::string cycle_labels = SaveLabels(HubLabelingRouter(cycle_graph));
+    const LabelsLayout cycle_layout = GetLayout(cycle_labels, 3);
+    const uint32_t hub = GetRank(cycle_labels, 3, 0);
+    assert(hub == 0);
+    const uint32_t index = GetEntryIndex(cycle_labels, cycle_layout, 0, 1, hub);
+    std::string corrupted = cycle_labels;
+    OverwriteIndex(corrupted, cycle_layout.parent_edges[0] + sizeof(uint32_t) * index, static_cast<uint32_t>(edge_1_2));
+    assert(!IsRejected(cycle_graph, cycle_labels));
+    assert(IsRejected(cycle_graph, corrupted));
+}
+
+void TestNegativeWeights() {
+    tests::Graph graph(2);
+    graph.AddEdge({0, 1, -1.0});
+    try {
+        HubLabelingRouter router(graph);
+        assert(false);
+    } catch (const std::domain_error&) {
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestRandomGraphs();
+    TestCorruptedLabels();
+    TestCorruptedParents();
+    TestNegativeWeights();
+    std::cout << "hub_labeling_test OK"s << std::endl;
+}
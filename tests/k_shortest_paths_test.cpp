@@ -0,0 +1,102 @@
+// the alternative routes are the lightest loopless routes found by enumerating all of them on small graphs:
+// distinct, in the order of their weights, within the weight gap, the first one as light as graph::Router's
+// g++ -std=c++17 -O2 -pthread -I.. k_shortest_paths_test.cpp ../thread_pool.cpp ../min_plus.cpp
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "csr_graph.h"
+#include "k_shortest_paths.h"
+#include "router.h"
+#include "test_graphs.h"
+#include "thread_pool.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+using KShortestPaths = graph::KShortestPaths<double>;
+using Direction = graph::CsrGraph<double>::Direction;
+
+bool IsLoopless(const tests::Graph& graph, graph::VertexId from, const tests::RouteInfo& route) {
+    std::vector<graph::VertexId> vertexes{from};
+    for (const graph::EdgeId edge_id : route.edges) {
+        vertexes.push_back(graph.GetEdge(edge_id).to);
+    }
+    std::sort(vertexes.begin(), vertexes.end());
+    return std::adjacent_find(vertexes.begin(), vertexes.end()) == vertexes.end();
+}
+
+// the weights are quarters, so they're compared exactly; of equal routes any may come first
+void CheckRoutes(const tests::Graph& graph, const graph::Router<double>& reference, const KShortestPaths& search,
+                 concurrency::ThreadPool& thread_pool, graph::VertexId from, graph::VertexId to) {
+    std::vector<tests::RouteInfo> all_routes = tests::FindLooplessRoutes(graph, from, to);
+    std::stable_sort(all_routes.begin(), all_routes.end(),
+                     [](const tests::RouteInfo& lhs, const tests::RouteInfo& rhs) { return lhs.weight < rhs.weight; });
+    const auto best_route = reference.BuildRoute(from, to);
+    assert(all_routes.empty() == !best_route);
+    assert(all_routes.empty() || all_routes.front().weight == best_route->weight);
+
+    for (const size_t route_count : {0, 1, 2, 5, 40}) {
+        for (const double max_weight_gap : {0.0, 1.5, 1e9}) {
+            const auto routes = search.FindRoutes(from, to, route_count, max_weight_gap, thread_pool);
+            size_t expected_count = 0;
+            while (expected_count < std::min(route_count, all_routes.size()) &&
+                   all_routes[expected_count].weight <= all_routes.front().weight + max_weight_gap) {
+                ++expected_count;
+            }
+            assert(routes.size() == expected_count);
+
+            for (size_t index = 0; index < routes.size(); ++index) {
+                tests::CheckRoutePath(graph, from, to, routes[index], 0.0);
+                assert(IsLoopless(graph, from, routes[index]));
+                assert(routes[index].weight == all_routes[index].weight);
+                for (size_t other_index = 0; other_index < index; ++other_index) {
+                    assert(routes[index].edges != routes[other_index].edges);
+                }
+            }
+        }
+    }
+}
+
+void TestKShortestPaths() {
+    std::mt19937 random(61);
+    concurrency::ThreadPool thread_pool(2);
+    concurrency::ThreadPool calling_thread(1);
+    for (size_t vertex_count : {1, 2, 4, 7}) {
+        for (size_t edge_factor : {1, 2, 3}) {
+            const tests::Graph graph = tests::MakeRandomGraph(vertex_count, vertex_count * edge_factor, random);
+            const graph::Router<double> reference(graph);
+            const graph::CsrGraph<double> forward_graph(graph, Direction::FORWARD);
+            const graph::CsrGraph<double> backward_graph(graph, Direction::BACKWARD);
+            const KShortestPaths search(graph, forward_graph, backward_graph);
+            for (graph::VertexId from = 0; from < vertex_count; ++from) {
+                for (graph::VertexId to = 0; to < vertex_count; ++to) {
+                    CheckRoutes(graph, reference, search, from % 2 == 0 ? thread_pool : calling_thread, from, to);
+                }
+            }
+        }
+    }
+
+    const tests::Graph graph = tests::MakeGridGraph(3, random);
+    const graph::Router<double> reference(graph);
+    const graph::CsrGraph<double> forward_graph(graph, Direction::FORWARD);
+    const graph::CsrGraph<double> backward_graph(graph, Direction::BACKWARD);
+    const KShortestPaths search(graph, forward_graph, backward_graph);
+    for (graph::VertexId from = 0; from < graph.GetVertexCount(); ++from) {
+        for (graph::VertexId to = 0; to < graph.GetVertexCount(); ++to) {
+            CheckRoutes(graph, reference, search, thread_pool, from, to);
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestKShortestPaths();
+    std::cout << "k_shortest_paths_test OK"s << std::endl;
+}
@@ -0,0 +1,205 @@
+// the LRU cache drops the least recently used entries of a shard, keeps nothing at capacity 0 and counts its
+// hits and misses under concurrent use; the route cache of the transport router is dropped by every update,
+// so the next route has the new time
+// g++ -std=c++17 -O2 -pthread -I.. lru_cache_test.cpp $(ls ../*.cpp | grep -v main.cpp)
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "json_reader.h"
+#include "lru_cache.h"
+#include "test_string.h"
+#include "transport_router.h"
+
+using namespace std::string_literals;
+using namespace transport_catalogue;
+
+namespace {
+
+using Cache = concurrency::LruCache<int, std::string>;
+
+bool IsCached(Cache& cache, int key) {
+    return cache.Get(key).has_value();
+}
+
+// one shard, so the order of eviction is that of the whole cache
+void TestEvictionOrder() {
+    Cache cache(3, 1);
+    cache.Put(1, "1"s);
+    cache.Put(2, "2"s);
+    cache.Put(3, "3"s);
+    assert(cache.Get(1) == "1"s);
+    // 1, 3, 2 by use
+    cache.Put(4, "4"s);
+    assert(!IsCached(cache, 2));
+    assert(IsCached(cache, 3));
+    assert(IsCached(cache, 1));
+    // 1, 3, 4 by use, putting a cached key replaces its value and uses it
+    cache.Put(4, "four"s);
+    cache.Put(5, "5"s);
+    assert(!IsCached(cache, 3));
+    assert(cache.Get(4) == "four"s);
+    assert(IsCached(cache, 1));
+    assert(IsCached(cache, 5));
+
+    const concurrency::CacheStats stats = cache.GetStats();
+    assert(stats.hits == 6);
+    assert(stats.misses == 2);
+
+    cache.Clear();
+    for (int key = 1; key <= 5; ++key) {
+        assert(!IsCached(cache, key));
+    }
+    assert(cache.GetStats().hits == 6);
+    assert(cache.GetStats().misses == 7);
+}
+
+void TestZeroCapacity() {
+    for (const size_t shard_count : {1, 16}) {
+        Cache cache(0, shard_count);
+        for (int key = 0; key < 100; ++key) {
+            cache.Put(key, std::to_string(key));
+            assert(!IsCached(cache, key));
+        }
+        assert(cache.GetStats().hits == 0);
+        assert(cache.GetStats().misses == 100);
+    }
+
+    try {
+        Cache cache(10, 0);
+        assert(false);
+    } catch (const std::invalid_argument&) {
+    }
+}
+
+// the shards share the capacity, so no more entries than it are kept whatever the keys, and the last key put
+// is always there
+void TestShardedCapacity() {
+    constexpr size_t kCapacity = 40;
+    Cache cache(kCapacity, 16);
+    for (int key = 0; key < 1000; ++key) {
+        cache.Put(key, std::to_string(key));
+        assert(cache.Get(key) == std::to_string(key));
+    }
+    size_t cached_count = 0;
+    for (int key = 0; key < 1000; ++key) {
+        cached_count += IsCached(cache, key) ? 1 : 0;
+    }
+    assert(cached_count > 0);
+    assert(cached_count <= kCapacity);
+}
+
+// every value got is the one put for its key, and every get is counted once
+void TestConcurrentUse() {
+    constexpr int kThreadCount = 4;
+    constexpr int kGetCount = 20000;
+    concurrency::LruCache<int, int> cache(64, 4);
+    std::vector<std::thread> threads;
+    for (int thread_index = 0; thread_index < kThreadCount; ++thread_index) {
+        threads.emplace_back([&cache, thread_index] {
+            for (int i = 0; i < kGetCount; ++i) {
+                const int key = (i * 7 + thread_index) % 200;
+                if (const auto value = cache.Get(key)) {
+                    assert(*value == key * 2);
+                } else {
+                    cache.Put(key, key * 2);
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    const concurrency::CacheStats stats = cache.GetStats();
+    assert(stats.hits + stats.misses == size_t{kThreadCount} * kGetCount);
+    assert(stats.hits > 0);
+}
+
+TransportCatalogue ReadCatalogue(const std::string& input, RoutingSettings& settings) {
+    std::istringstream input_stream{input};
+    json_reader::JsonReader reader;
+    reader.ReadJson(input_stream);
+    settings = json_reader::BuildRoutingSettings(reader.GetRoutingSettings());
+    return json_reader::ReadTransportCatalogue(reader.GetBaseRequests());
+}
+
+// the route right after an update misses the cache and has the time of a router built anew
+std::optional<router::TransportRouter::Route> CheckUpdatedRoute(const TransportCatalogue& catalogue,
+                                                                const RoutingSettings& settings,
+                                                                const router::RouterOptions& options,
+                                                                const router::TransportRouter& transport_router,
+                                                                StopPtr stop_from, StopPtr stop_to) {
+    const concurrency::CacheStats stats = transport_router.GetRouteCacheStats();
+    const auto route = transport_router.GetRouteInfo(stop_from, stop_to);
+    assert(transport_router.GetRouteCacheStats().hits == stats.hits);
+    assert(transport_router.GetRouteCacheStats().misses == stats.misses + 1);
+
+    const auto expected = router::TransportRouter(catalogue, settings, options).GetRouteInfo(stop_from, stop_to);
+    assert(route.has_value() == expected.has_value());
+    if (route) {
+        assert(std::abs(route->first - expected->first) <= 1e-9);
+    }
+
+    transport_router.GetRouteInfo(stop_from, stop_to);
+    assert(transport_router.GetRouteCacheStats().hits == stats.hits + 1);
+    return route;
+}
+
+void TestRouteCacheInvalidation() {
+    RoutingSettings settings{};
+    TransportCatalogue catalogue = ReadCatalogue(test_string2, settings);
+    router::RouterOptions options;
+    options.engine = router::RoutingEngine::DIJKSTRA;
+    router::TransportRouter transport_router(catalogue, settings, options);
+
+    // a ride between the first two stops of a bus gets faster with a shorter distance between them
+    const Bus& bus = catalogue.GetAllBuses().front();
+    assert(bus.stops.size() > 1);
+    StopPtr stop_from = bus.stops[0];
+    StopPtr stop_to = bus.stops[1];
+    const auto route = transport_router.GetRouteInfo(stop_from, stop_to);
+    assert(route);
+    catalogue.AddDistancesBetweenStops(stop_from, stop_to,
+                                       std::max(1, catalogue.GetDistanceBetweenStops(stop_from, stop_to) / 4));
+    transport_router.UpdateDistance(stop_from, stop_to);
+    const auto faster_route = CheckUpdatedRoute(catalogue, settings, options, transport_router, stop_from, stop_to);
+    assert(faster_route && faster_route->first < route->first);
+
+    // a new bus from the last stop to the first one
+    StopPtr last_stop = &catalogue.GetAllStops().back();
+    StopPtr first_stop = &catalogue.GetAllStops().front();
+    transport_router.GetRouteInfo(last_stop, first_stop);
+    if (!catalogue.ContainsDistanceBetweenStops(last_stop, first_stop) &&
+        !catalogue.ContainsDistanceBetweenStops(first_stop, last_stop)) {
+        catalogue.AddDistancesBetweenStops(last_stop, first_stop, 1);
+    }
+    catalogue.AddBus("Test bus"s, {last_stop->name, first_stop->name}, false);
+    transport_router.UpdateBuses({catalogue.GetBus("Test bus"s)});
+    CheckUpdatedRoute(catalogue, settings, options, transport_router, last_stop, first_stop);
+
+    // a longer wait adds to every route that boards
+    const auto route_before_wait = transport_router.GetRouteInfo(stop_from, stop_to);
+    settings.wait_time += 2;
+    transport_router.UpdateRoutingSettings(settings);
+    const auto slower_route = CheckUpdatedRoute(catalogue, settings, options, transport_router, stop_from, stop_to);
+    assert(slower_route && slower_route->first >= route_before_wait->first + 2.0 - 1e-9);
+}
+
+}  // namespace
+
+int main() {
+    TestEvictionOrder();
+    TestZeroCapacity();
+    TestShardedCapacity();
+    TestConcurrentUse();
+    TestRouteCacheInvalidation();
+    std::cout << "lru_cache_test OK"s << std::endl;
+}
@@ -0,0 +1,72 @@
+// the min-plus kernel relaxes rows like the scalar loop, with AVX2 where the CPU supports it
+// g++ -std=c++17 -O2 -I.. min_plus_test.cpp ../min_plus.cpp
+
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "min_plus.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+// a quarter of the cells unreachable and a quarter of the routes without edges, the lengths cover
+// the vector tails of both weight types
+template <typename Weight>
+void TestRelaxRow(std::mt19937& random) {
+    constexpr Weight INFINITE_WEIGHT = std::numeric_limits<Weight>::infinity();
+    std::uniform_int_distribution<int> weight_steps(0, 64);
+    std::uniform_int_distribution<int> quarter(0, 3);
+    std::uniform_int_distribution<uint32_t> edge(0, 1000);
+    const auto random_weight = [&] {
+        return quarter(random) == 0 ? INFINITE_WEIGHT : static_cast<Weight>(weight_steps(random) * 0.5);
+    };
+    const auto random_edge = [&] {
+        return quarter(random) == 0 ? NO_EDGE : edge(random);
+    };
+
+    for (size_t count = 0; count < 40; ++count) {
+        for (int attempt = 0; attempt < 50; ++attempt) {
+            const Weight weight_from = static_cast<Weight>(weight_steps(random) * 0.5);
+            const uint32_t prev_edge_from = edge(random);
+            std::vector<Weight> weights_through(count);
+            std::vector<uint32_t> prev_edges_through(count);
+            std::vector<Weight> weights(count);
+            std::vector<uint32_t> prev_edges(count);
+            for (size_t i = 0; i < count; ++i) {
+                weights_through[i] = random_weight();
+                prev_edges_through[i] = random_edge();
+                weights[i] = random_weight();
+                prev_edges[i] = random_edge();
+            }
+
+            std::vector<Weight> expected_weights = weights;
+            std::vector<uint32_t> expected_prev_edges = prev_edges;
+            graph::min_plus::RelaxRowScalar(weight_from, prev_edge_from, weights_through.data(),
+                                            prev_edges_through.data(), expected_weights.data(),
+                                            expected_prev_edges.data(), count, INFINITE_WEIGHT, NO_EDGE);
+            graph::min_plus::RelaxRow(weight_from, prev_edge_from, weights_through.data(),
+                                      prev_edges_through.data(), weights.data(), prev_edges.data(), count);
+
+            assert(weights == expected_weights);
+            assert(prev_edges == expected_prev_edges);
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 random(7);
+    TestRelaxRow<double>(random);
+    TestRelaxRow<float>(random);
+    std::cout << "min_plus_test OK"s << (graph::min_plus::HasSimdSupport() ? " (AVX2)"s : " (scalar)"s)
+              << std::endl;
+}
@@ -0,0 +1,191 @@
+// the multilevel overlay answers like graph::Router over partitions of any depth, after customizing
+// the cliques to new weights and over a partition loaded from a stream
+// g++ -std=c++17 -O2 -pthread -I.. multilevel_overlay_test.cpp ../thread_pool.cpp ../min_plus.cpp
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "multilevel_overlay_router.h"
+#include "test_graphs.h"
+#include "thread_pool.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+using MultilevelOverlayRouter = graph::MultilevelOverlayRouter<double>;
+
+std::string SavePartition(const MultilevelOverlayRouter& router) {
+    std::ostringstream output;
+    router.Save(output);
+    return output.str();
+}
+
+bool IsRejected(const tests::Graph& graph, const std::string& partition) {
+    std::istringstream input{partition};
+    try {
+        MultilevelOverlayRouter router(graph, input);
+    } catch (const std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+template <typename Value>
+Value Read(const std::string& data, size_t position) {
+    Value value{};
+    std::memcpy(&value, data.data() + position, sizeof(value));
+    return value;
+}
+
+template <typename Value>
+void Overwrite(std::string& data, size_t position, Value value) {
+    std::memcpy(data.data() + position, &value, sizeof(value));
+}
+
+void CheckPartitions(const tests::Graph& graph, concurrency::ThreadPool& thread_pool) {
+    const graph::Router<double> reference(graph);
+    for (size_t cell_size : {2, 4, 16, 128}) {
+        for (size_t level_factor : {2, 8}) {
+            const MultilevelOverlayRouter router(graph, &thread_pool, cell_size, level_factor);
+            tests::CheckSameRoutes(graph, reference, router);
+        }
+    }
+    tests::CheckSameRoutes(graph, reference, MultilevelOverlayRouter(graph));
+}
+
+void TestPartitions() {
+    std::mt19937 random(19);
+    concurrency::ThreadPool thread_pool(2);
+    for (size_t vertex_count : {1, 2, 10, 50, 200}) {
+        for (size_t edge_factor : {1, 3}) {
+            CheckPartitions(tests::MakeRandomGraph(vertex_count, vertex_count * edge_factor, random), thread_pool);
+        }
+    }
+    CheckPartitions(tests::MakeGridGraph(15, random), thread_pool);
+}
+
+// the cliques are customized to the new weights, the added edges and without the removed ones
+void TestUpdateEdges() {
+    std::mt19937 random(23);
+    std::uniform_int_distribution<int> quarters(0, 40);
+    tests::Graph graph = tests::MakeGridGraph(12, random);
+    MultilevelOverlayRouter router(graph, nullptr, 4, 2);
+    assert(router.GetLevelCount() > 2);
+    std::uniform_int_distribution<graph::VertexId> any_vertex(0, graph.GetVertexCount() - 1);
+
+    for (int round = 0; round < 5; ++round) {
+        std::vector<graph::EdgeId> edge_ids;
+        std::uniform_int_distribution<graph::EdgeId> any_edge(0, graph.GetEdgeCount() - 1);
+        for (int i = 0; i < 10; ++i) {
+            const graph::EdgeId edge_id = any_edge(random);
+            if (!graph.IsEdgeRemoved(edge_id)) {
+                graph.SetEdgeWeight(edge_id, quarters(random) * 0.25);
+                edge_ids.push_back(edge_id);
+            }
+        }
+        edge_ids.push_back(graph.AddEdge({any_vertex(random), any_vertex(random), quarters(random) * 0.25}));
+        const graph::EdgeId removed_edge_id = any_edge(random);
+        if (!graph.IsEdgeRemoved(removed_edge_id)) {
+            graph.RemoveEdge(removed_edge_id);
+            edge_ids.push_back(removed_edge_id);
+        }
+
+        assert(router.UpdateEdges(edge_ids));
+        tests::CheckSameRoutes(graph, graph::Router<double>(graph), router);
+    }
+}
+
+// the header holds the vertex and level counts in 64 bits, then the cell counts of the levels and the cells
+// of the vertexes level by level in 32 bits; partitions whose cells don't nest level by level are rejected
+void TestSavedPartition() {
+    std::mt19937 random(29);
+    tests::Graph graph = tests::MakeGridGraph(10, random);
+    const size_t vertex_count = graph.GetVertexCount();
+    const std::string partition = SavePartition(MultilevelOverlayRouter(graph, nullptr, 4, 2));
+    const graph::Router<double> reference(graph);
+    {
+        std::istringstream input{partition};
+        tests::CheckSameRoutes(graph, reference, MultilevelOverlayRouter(graph, input));
+    }
+
+    // the partition depends only on the vertexes, so another graph over them may use it
+    tests::Graph other_graph = tests::MakeGridGraph(10, random);
+    {
+        std::istringstream input{partition};
+        tests::CheckSameRoutes(other_graph, graph::Router<double>(other_graph),
+                               MultilevelOverlayRouter(other_graph, input));
+    }
+
+    assert(!IsRejected(graph, partition));
+    assert(IsRejected(graph, ""s));
+    assert(IsRejected(graph, partition.substr(0, partition.size() - 1)));
+    assert(IsRejected(tests::Graph(vertex_count + 1), partition));
+
+    const uint64_t level_count = Read<uint64_t>(partition, sizeof(uint64_t));
+    assert(level_count > 1);
+    const size_t counts_position = 2 * sizeof(uint64_t);
+    const size_t cells_position = counts_position + level_count * sizeof(uint32_t);
+    const auto get_cell_position = [&](size_t level, size_t vertex) {
+        return cells_position + (level * vertex_count + vertex) * sizeof(uint32_t);
+    };
+    const uint32_t cell_count = Read<uint32_t>(partition, counts_position);
+    const uint32_t upper_cell_count = Read<uint32_t>(partition, counts_position + sizeof(uint32_t));
+
+    // as many levels as vertexes is more than the input holds, rejected before anything is allocated for them
+    std::string corrupted = partition;
+    Overwrite(corrupted, sizeof(uint64_t), static_cast<uint64_t>(vertex_count));
+    assert(IsRejected(graph, corrupted));
+
+    // no cells, more cells than vertexes, a level of as many cells as the one below and an empty cell
+    for (const auto& [level, count] : {std::pair<size_t, uint32_t>{0, 0}, {0, vertex_count + 1},
+                                       {1, cell_count}, {0, cell_count + 1}}) {
+        corrupted = partition;
+        Overwrite(corrupted, counts_position + level * sizeof(uint32_t), count);
+        assert(IsRejected(graph, corrupted));
+    }
+
+    // the first vertex in a cell past the cells of the first level
+    corrupted = partition;
+    Overwrite(corrupted, get_cell_position(0, 0), cell_count);
+    assert(IsRejected(graph, corrupted));
+
+    // a vertex moved to another cell of the second level away from a vertex of its cell of the first level
+    size_t vertex = 1;
+    while (Read<uint32_t>(partition, get_cell_position(0, vertex)) != Read<uint32_t>(partition, cells_position)) {
+        ++vertex;
+    }
+    const uint32_t upper_cell = Read<uint32_t>(partition, get_cell_position(1, vertex));
+    corrupted = partition;
+    Overwrite(corrupted, get_cell_position(1, vertex), (upper_cell + 1) % upper_cell_count);
+    assert(IsRejected(graph, corrupted));
+}
+
+void TestInvalidOptions() {
+    const tests::Graph graph(3);
+    for (const auto& [cell_size, level_factor] : {std::pair<size_t, size_t>{1, 8}, {128, 1}}) {
+        try {
+            MultilevelOverlayRouter router(graph, nullptr, cell_size, level_factor);
+            assert(false);
+        } catch (const std::invalid_argument&) {
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestPartitions();
+    TestUpdateEdges();
+    TestSavedPartition();
+    TestInvalidOptions();
+    std::cout << "multilevel_overlay_test OK"s << std::endl;
+}
@@ -0,0 +1,130 @@
+// the Pareto routes by weight and counted edges are the Pareto set of all loopless routes, found by
+// enumerating them on small random graphs, and the Pareto routes of the transport router get slower
+// as they board fewer times
+// g++ -std=c++17 -O2 -pthread -I.. pareto_search_test.cpp $(ls ../*.cpp | grep -v main.cpp)
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "csr_graph.h"
+#include "json_reader.h"
+#include "pareto_search.h"
+#include "test_graphs.h"
+#include "test_string.h"
+#include "transport_router.h"
+
+using namespace std::string_literals;
+using namespace transport_catalogue;
+
+namespace {
+
+using ParetoSearch = graph::ParetoSearch<double>;
+using Direction = graph::CsrGraph<double>::Direction;
+
+// the weights are quarters, so they're compared exactly
+void CheckRoutes(const tests::Graph& graph, const std::vector<bool>& counted_edges, const ParetoSearch& search,
+                 graph::VertexId from, graph::VertexId to) {
+    for (const size_t max_count : {0, 1, 2, 5}) {
+        const auto routes = search.FindRoutes(from, to, max_count);
+        const auto pareto_set = tests::FindParetoSet(graph, from, to, counted_edges, max_count);
+        assert(routes.size() == pareto_set.size());
+        for (size_t index = 0; index < routes.size(); ++index) {
+            const auto& route = routes[index];
+            assert(route.weight == pareto_set[index].first);
+            assert(route.count == pareto_set[index].second);
+            tests::CheckRoutePath(graph, from, to, {route.weight, route.edges}, 0.0);
+            size_t count = 0;
+            for (const graph::EdgeId edge_id : route.edges) {
+                count += counted_edges[edge_id] ? 1 : 0;
+            }
+            assert(count == route.count);
+        }
+    }
+}
+
+void TestParetoSearch() {
+    std::mt19937 random(67);
+    std::bernoulli_distribution is_counted(0.5);
+    std::vector<tests::Graph> graphs;
+    for (size_t vertex_count : {1, 2, 4, 7}) {
+        for (size_t edge_factor : {1, 2, 3}) {
+            graphs.push_back(tests::MakeRandomGraph(vertex_count, vertex_count * edge_factor, random));
+        }
+    }
+    graphs.push_back(tests::MakeGridGraph(3, random));
+
+    for (const tests::Graph& graph : graphs) {
+        std::vector<bool> counted_edges(graph.GetEdgeCount());
+        for (size_t edge_id = 0; edge_id < counted_edges.size(); ++edge_id) {
+            counted_edges[edge_id] = is_counted(random);
+        }
+        const graph::CsrGraph<double> forward_graph(graph, Direction::FORWARD);
+        const graph::CsrGraph<double> backward_graph(graph, Direction::BACKWARD);
+        const ParetoSearch search(forward_graph, backward_graph, counted_edges);
+        for (graph::VertexId from = 0; from < graph.GetVertexCount(); ++from) {
+            for (graph::VertexId to = 0; to < graph.GetVertexCount(); ++to) {
+                CheckRoutes(graph, counted_edges, search, from, to);
+            }
+        }
+    }
+}
+
+TransportCatalogue ReadCatalogue(const std::string& input, RoutingSettings& settings) {
+    std::istringstream input_stream{input};
+    json_reader::JsonReader reader;
+    reader.ReadJson(input_stream);
+    settings = json_reader::BuildRoutingSettings(reader.GetRoutingSettings());
+    return json_reader::ReadTransportCatalogue(reader.GetBaseRequests());
+}
+
+size_t CountBoardings(const router::TransportRouter::Route& route) {
+    size_t boardings = 0;
+    for (const auto& item : route.second) {
+        boardings += std::holds_alternative<router::TransportRouter::BusRideInfo>(item) ? 1 : 0;
+    }
+    return boardings;
+}
+
+// the routes get slower and board fewer times, and the first one is as fast as the fastest route
+void TestParetoRoutes() {
+    for (const std::string* input : {&test_string, &test_string2, &test_string3}) {
+        RoutingSettings settings{};
+        const TransportCatalogue catalogue = ReadCatalogue(*input, settings);
+        for (const auto model : {router::RouteGraphModel::STOP_TO_STOP, router::RouteGraphModel::ON_BOARD}) {
+            router::RouterOptions options;
+            options.graph_model = model;
+            const router::TransportRouter transport_router(catalogue, settings, options);
+            for (const Stop& stop_from : catalogue.GetAllStops()) {
+                for (const Stop& stop_to : catalogue.GetAllStops()) {
+                    const auto fastest = transport_router.GetRouteInfo(&stop_from, &stop_to);
+                    const auto routes = transport_router.GetParetoRoutes(&stop_from, &stop_to, 10);
+                    assert(routes.empty() == !fastest);
+                    for (size_t index = 0; index < routes.size(); ++index) {
+                        assert(CountBoardings(routes[index]) <= 10);
+                        if (index > 0) {
+                            assert(routes[index - 1].first < routes[index].first);
+                            assert(CountBoardings(routes[index]) < CountBoardings(routes[index - 1]));
+                        }
+                    }
+                    if (fastest) {
+                        assert(std::abs(routes.front().first - fastest->first) <= 1e-9);
+                    }
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestParetoSearch();
+    TestParetoRoutes();
+    std::cout << "pareto_search_test OK"s << std::endl;
+}
@@ -0,0 +1,104 @@
+// the radix heap gives the keys in the order a binary heap does under the monotone pushes of a Dijkstra search,
+// of equal keys the last pushed first, over the whole range of its key type
+// g++ -std=c++17 -O2 -I.. radix_heap_test.cpp
+
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "radix_heap.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+// pushes keys no less than the last top, many equal to it, and pops in between; the values are the push order,
+// so the reference takes the least key and of equal ones the greatest value
+template <typename Key>
+void CheckMonotoneQueue(std::mt19937_64& random, Key max_step) {
+    using Item = std::pair<Key, size_t>;
+    const auto is_after = [](const Item& lhs, const Item& rhs) {
+        return lhs.first != rhs.first ? lhs.first > rhs.first : lhs.second < rhs.second;
+    };
+    graph::RadixHeap<Key, size_t> heap;
+    std::priority_queue<Item, std::vector<Item>, decltype(is_after)> reference(is_after);
+    std::uniform_int_distribution<uint64_t> step(0, max_step);
+    std::uniform_int_distribution<int> action(0, 2);
+    Key last_key = 0;
+    size_t push_count = 0;
+
+    for (int i = 0; i < 20000; ++i) {
+        if (action(random) > 0 || reference.empty()) {
+            const Key key = step(random) % 3 == 0 || std::numeric_limits<Key>::max() - last_key < max_step
+                                ? last_key
+                                : static_cast<Key>(last_key + step(random));
+            heap.Push(key, push_count);
+            reference.push({key, push_count});
+            ++push_count;
+            continue;
+        }
+
+        assert(!heap.IsEmpty());
+        assert(heap.GetTop() == reference.top());
+        last_key = reference.top().first;
+        heap.Pop();
+        reference.pop();
+    }
+
+    while (!reference.empty()) {
+        assert(heap.GetTop() == reference.top());
+        heap.Pop();
+        reference.pop();
+    }
+    assert(heap.IsEmpty());
+}
+
+void TestMonotoneQueues() {
+    std::mt19937_64 random(71);
+    CheckMonotoneQueue<uint16_t>(random, 3);
+    CheckMonotoneQueue<uint16_t>(random, 300);
+    CheckMonotoneQueue<uint32_t>(random, 100);
+    CheckMonotoneQueue<uint32_t>(random, 1u << 20);
+    CheckMonotoneQueue<uint64_t>(random, 1000);
+    CheckMonotoneQueue<uint64_t>(random, uint64_t{1} << 50);
+}
+
+// keys at both ends of the range, and the heap starts over from key 0 after Clear
+void TestExtremeKeys() {
+    constexpr uint64_t kMax = std::numeric_limits<uint64_t>::max();
+    graph::RadixHeap<uint64_t, int> heap;
+    heap.Push(kMax, 1);
+    heap.Push(0, 2);
+    heap.Push(kMax - 1, 3);
+    assert(heap.GetTop() == std::make_pair(uint64_t{0}, 2));
+    heap.Pop();
+    assert(heap.GetTop() == std::make_pair(kMax - 1, 3));
+    heap.Pop();
+    heap.Push(kMax, 4);
+    assert(heap.GetTop() == std::make_pair(kMax, 4));
+    heap.Pop();
+    assert(heap.GetTop() == std::make_pair(kMax, 1));
+    heap.Pop();
+    assert(heap.IsEmpty());
+
+    heap.Push(kMax, 5);
+    heap.Clear();
+    assert(heap.IsEmpty());
+    heap.Push(7, 6);
+    heap.Push(3, 7);
+    assert(heap.GetTop() == std::make_pair(uint64_t{3}, 7));
+}
+
+}  // namespace
+
+int main() {
+    TestMonotoneQueues();
+    TestExtremeKeys();
+    std::cout << "radix_heap_test OK"s << std::endl;
+}
@@ -0,0 +1,186 @@
+// the request handler answers malformed route requests with an error instead of routing them, and answers
+// the requests that don't route while the router is built in the background
+// g++ -std=c++17 -O2 -pthread -I.. request_handler_test.cpp $(ls ../*.cpp | grep -v main.cpp)
+
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "json_reader.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "test_string.h"
+#include "transport_router.h"
+
+using namespace std::string_literals;
+using namespace transport_catalogue;
+
+namespace {
+
+json_reader::JsonReader ReadJson(const std::string& input) {
+    std::istringstream input_stream{input};
+    json_reader::JsonReader reader;
+    reader.ReadJson(input_stream);
+    return reader;
+}
+
+// what main builds the request handler from
+struct Inputs {
+    explicit Inputs(const std::string& input)
+    : reader(ReadJson(input))
+    , catalogue(json_reader::ReadTransportCatalogue(reader.GetBaseRequests()))
+    , renderer(catalogue, json_reader::ReadRenderSettings(reader.GetRenderSettings()))
+    , settings(json_reader::BuildRoutingSettings(reader.GetRoutingSettings()))
+    {
+    }
+
+    json_reader::JsonReader reader;
+    TransportCatalogue catalogue;
+    renderer::MapRenderer renderer;
+    RoutingSettings settings;
+};
+
+std::string GetErrorMessage(const json::Node& response) {
+    const json::Dict& dict = response.AsDict();
+    return dict.count("error_message"s) ? dict.at("error_message"s).AsString() : ""s;
+}
+
+void TestInvalidRouteRequests() {
+    const Inputs inputs(test_string);
+    const TransportCatalogue& catalogue = inputs.catalogue;
+    const router::TransportRouter transport_router(catalogue, inputs.settings);
+    const request_handler::RequestHandler handler(catalogue, inputs.renderer, transport_router);
+
+    RouteInfo route_info;
+    route_info.from = catalogue.GetAllStops().front().name;
+    route_info.to = catalogue.GetAllStops().back().name;
+    const auto get_error_message = [&handler](const RouteInfo& info) {
+        return GetErrorMessage(handler.GetResponseToStatRequest("Route"sv, 1, {}, info));
+    };
+    assert(get_error_message(route_info) != "invalid route request"s);
+
+    RouteInfo pareto_info = route_info;
+    pareto_info.pareto = true;
+    pareto_info.max_boardings = 0;
+    assert(get_error_message(pareto_info) != "invalid route request"s);
+
+    // negative counts and gaps, and alternatives along with the Pareto set
+    for (const int max_boardings : {-1, -1000}) {
+        pareto_info.max_boardings = max_boardings;
+        assert(get_error_message(pareto_info) == "invalid route request"s);
+        RouteInfo invalid_info = route_info;
+        invalid_info.max_boardings = max_boardings;
+        assert(get_error_message(invalid_info) == "invalid route request"s);
+    }
+    RouteInfo invalid_info = route_info;
+    invalid_info.alternatives = -1;
+    assert(get_error_message(invalid_info) == "invalid route request"s);
+    invalid_info = route_info;
+    invalid_info.alternatives = RouteInfo::MAX_ALTERNATIVES + 1;
+    assert(get_error_message(invalid_info) == "invalid route request"s);
+    invalid_info = route_info;
+    invalid_info.max_time_gap = -1.0;
+    assert(get_error_message(invalid_info) == "invalid route request"s);
+    invalid_info = route_info;
+    invalid_info.pareto = true;
+    invalid_info.alternatives = 1;
+    assert(get_error_message(invalid_info) == "invalid route request"s);
+}
+
+using RouterFuture = std::shared_future<std::unique_ptr<router::TransportRouter>>;
+
+// the requests that don't route never wait for the router
+void CheckNonRoutingRequests(const Inputs& inputs, const request_handler::RequestHandler& handler) {
+    const Stop& stop = inputs.catalogue.GetAllStops().front();
+    const Bus& bus = inputs.catalogue.GetAllBuses().front();
+    auto responses = std::async(std::launch::async, [&] {
+        return std::vector<json::Node>{handler.GetResponseToStatRequest("Stop"sv, 1, stop.name),
+                                       handler.GetResponseToStatRequest("Bus"sv, 2, bus.name),
+                                       handler.GetResponseToStatRequest("Map"sv, 3)};
+    });
+    assert(responses.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+    const std::vector<json::Node> nodes = responses.get();
+    assert(nodes[0].AsDict().count("buses"s));
+    assert(nodes[1].AsDict().count("curvature"s));
+    assert(nodes[2].AsDict().count("map"s));
+}
+
+// a route of the handler has the time of the route of a router of its own
+void CheckRoute(const Inputs& inputs, const json::Node& response, const RouteInfo& route_info) {
+    const router::TransportRouter transport_router(inputs.catalogue, inputs.settings);
+    const auto route = transport_router.GetRouteInfo(inputs.catalogue.GetStop(route_info.from),
+                                                     inputs.catalogue.GetStop(route_info.to));
+    assert(route);
+    assert(GetErrorMessage(response).empty());
+    assert(std::abs(response.AsDict().at("total_time"s).AsDouble() - route->first) <= 1e-6);
+}
+
+// until the router is built the routing requests get the "router warming" error, the others their answers
+void TestWarmingRouter() {
+    const Inputs inputs(test_string);
+    std::promise<std::unique_ptr<router::TransportRouter>> router_promise;
+    const request_handler::RequestHandler handler(inputs.catalogue, inputs.renderer,
+                                                  RouterFuture(router_promise.get_future()), false);
+
+    CheckNonRoutingRequests(inputs, handler);
+
+    RouteInfo route_info;
+    route_info.from = inputs.catalogue.GetAllStops().front().name;
+    route_info.to = inputs.catalogue.GetAllStops().back().name;
+    RouteMatrixInfo route_matrix_info{{route_info.from}, {route_info.to}, false};
+    IsochroneInfo isochrone_info{route_info.from, 10.0, false};
+    assert(GetErrorMessage(handler.GetResponseToStatRequest("Route"sv, 4, {}, route_info)) == "router warming"s);
+    assert(GetErrorMessage(handler.GetResponseToStatRequest("RouteMatrix"sv, 5, {}, {}, route_matrix_info)) ==
+           "router warming"s);
+    assert(GetErrorMessage(handler.GetResponseToStatRequest("Isochrone"sv, 6, {}, {}, {}, isochrone_info)) ==
+           "router warming"s);
+
+    router_promise.set_value(std::make_unique<router::TransportRouter>(inputs.catalogue, inputs.settings));
+    CheckRoute(inputs, handler.GetResponseToStatRequest("Route"sv, 7, {}, route_info), route_info);
+    assert(GetErrorMessage(handler.GetResponseToStatRequest("RouteMatrix"sv, 8, {}, {}, route_matrix_info))
+               .empty());
+    assert(GetErrorMessage(handler.GetResponseToStatRequest("Isochrone"sv, 9, {}, {}, {}, isochrone_info)).empty());
+}
+
+// a route request waits for the router being built and is answered once it is
+void TestWaitingForRouter() {
+    const Inputs inputs(test_string);
+    std::promise<std::unique_ptr<router::TransportRouter>> router_promise;
+    const request_handler::RequestHandler handler(inputs.catalogue, inputs.renderer,
+                                                  RouterFuture(router_promise.get_future()));
+
+    CheckNonRoutingRequests(inputs, handler);
+
+    RouteInfo route_info;
+    route_info.from = inputs.catalogue.GetAllStops().front().name;
+    route_info.to = inputs.catalogue.GetAllStops().back().name;
+    auto response = std::async(std::launch::async, [&handler, &route_info] {
+        return handler.GetResponseToStatRequest("Route"sv, 1, {}, route_info);
+    });
+    assert(response.wait_for(std::chrono::milliseconds(100)) == std::future_status::timeout);
+
+    router_promise.set_value(std::make_unique<router::TransportRouter>(inputs.catalogue, inputs.settings));
+    CheckRoute(inputs, response.get(), route_info);
+}
+
+void TestWaitForRouterSetting() {
+    assert(json_reader::IsWaitingForRouter({}));
+    assert(json_reader::IsWaitingForRouter({{"wait_for_router"s, true}}));
+    assert(!json_reader::IsWaitingForRouter({{"wait_for_router"s, false}}));
+}
+
+}  // namespace
+
+int main() {
+    TestInvalidRouteRequests();
+    TestWarmingRouter();
+    TestWaitingForRouter();
+    TestWaitForRouterSetting();
+    std::cout << "request_handler_test OK"s << std::endl;
+}
@@ -0,0 +1,74 @@
+// the on-board model answers the stat requests byte for byte as the stop-to-stop model does: of the routes of
+// the same time it picks the same one, with the same total
+// g++ -std=c++17 -O2 -pthread -I.. route_graph_model_test.cpp $(ls ../*.cpp | grep -v main.cpp)
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "json.h"
+#include "json_reader.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "test_string.h"
+#include "transport_router.h"
+
+using namespace std::string_literals;
+using namespace transport_catalogue;
+
+namespace {
+
+constexpr size_t kMaxAllPairsOnBoardStopCount = 50;
+
+// the responses to the stat requests of the input as main prints them
+std::string GetResponses(const std::string& input, const router::RouterOptions& options) {
+    std::istringstream input_stream{input};
+    json_reader::JsonReader reader;
+    reader.ReadJson(input_stream);
+    const TransportCatalogue catalogue = json_reader::ReadTransportCatalogue(reader.GetBaseRequests());
+    const renderer::MapRenderer renderer(catalogue, json_reader::ReadRenderSettings(reader.GetRenderSettings()));
+    const router::TransportRouter transport_router(
+        catalogue, json_reader::BuildRoutingSettings(reader.GetRoutingSettings()), options);
+    const request_handler::RequestHandler handler(catalogue, renderer, transport_router);
+
+    std::ostringstream output;
+    json::Print(json::Document(json_reader::HandleRequests(reader.GetStatRequests(), handler)), output);
+    return output.str();
+}
+
+size_t CountStops(const std::string& input) {
+    std::istringstream input_stream{input};
+    json_reader::JsonReader reader;
+    reader.ReadJson(input_stream);
+    return json_reader::ReadTransportCatalogue(reader.GetBaseRequests()).GetAllStops().size();
+}
+
+void TestSameResponses() {
+    for (const std::string* input : {&test_string, &test_string2, &test_string3, &test_string4}) {
+        const std::string expected = GetResponses(*input, {});
+        const size_t stop_count = CountStops(*input);
+
+        router::RouterOptions options;
+        options.graph_model = router::RouteGraphModel::ON_BOARD;
+        std::vector<router::RoutingEngine> engines{router::RoutingEngine::DIJKSTRA,
+                                                   router::RoutingEngine::CONTRACTION_HIERARCHY,
+                                                   router::RoutingEngine::FIXED_POINT_DIJKSTRA};
+        // the all-pairs table over the on-board graph of the largest catalogue takes a minute
+        if (stop_count <= kMaxAllPairsOnBoardStopCount) {
+            engines.push_back(router::RoutingEngine::ALL_PAIRS);
+        }
+        for (const router::RoutingEngine engine : engines) {
+            options.engine = engine;
+            assert(GetResponses(*input, options) == expected);
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestSameResponses();
+    std::cout << "route_graph_model_test OK"s << std::endl;
+}
@@ -0,0 +1,136 @@
+// every cell of a route matrix is the route GetRouteInfo builds between its stops, with or without the items,
+// for every engine and graph model
+// g++ -std=c++17 -O2 -pthread -I.. route_matrix_test.cpp $(ls ../*.cpp | grep -v main.cpp)
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "json_reader.h"
+#include "test_string.h"
+#include "transport_router.h"
+
+using namespace std::string_literals;
+using namespace transport_catalogue;
+
+namespace {
+
+constexpr double kTolerance = 1e-9;
+
+TransportCatalogue ReadCatalogue(const std::string& input, RoutingSettings& settings) {
+    std::istringstream input_stream{input};
+    json_reader::JsonReader reader;
+    reader.ReadJson(input_stream);
+    settings = json_reader::BuildRoutingSettings(reader.GetRoutingSettings());
+    return json_reader::ReadTransportCatalogue(reader.GetBaseRequests());
+}
+
+std::vector<StopPtr> GetStops(const TransportCatalogue& catalogue) {
+    std::vector<StopPtr> stops;
+    for (const Stop& stop : catalogue.GetAllStops()) {
+        stops.push_back(&stop);
+    }
+    return stops;
+}
+
+// the items start with a wait at the origin, ride and wait in turn and sum to the time of the route
+void CheckItems(StopPtr stop_from, const router::TransportRouter::Route& route) {
+    double time = 0.0;
+    for (size_t index = 0; index < route.second.size(); ++index) {
+        const auto& item = route.second[index];
+        if (const auto* wait = std::get_if<router::TransportRouter::WaitInfo>(&item)) {
+            assert(index % 2 == 0);
+            assert(index > 0 || wait->stop_name == stop_from->name);
+            time += wait->time;
+        } else {
+            const auto& ride = std::get<router::TransportRouter::BusRideInfo>(item);
+            assert(index % 2 == 1);
+            assert(ride.span_count > 0);
+            time += ride.time;
+        }
+    }
+    assert(route.second.size() % 2 == 0);
+    assert(std::abs(time - route.first) <= kTolerance);
+}
+
+// the rows and the columns differ: the origins are every stop, the destinations every other one backwards
+void CheckRouteMatrix(const router::TransportRouter& transport_router, const router::TransportRouter& reference,
+                      const std::vector<StopPtr>& stops, bool with_items) {
+    std::vector<StopPtr> stops_to;
+    for (size_t index = 0; index < stops.size(); index += 2) {
+        stops_to.push_back(stops[index]);
+    }
+    std::reverse(stops_to.begin(), stops_to.end());
+
+    const auto matrix = transport_router.GetRouteMatrix(stops, stops_to, with_items);
+    assert(matrix.size() == stops.size());
+    for (size_t row = 0; row < stops.size(); ++row) {
+        assert(matrix[row].size() == stops_to.size());
+        for (size_t column = 0; column < stops_to.size(); ++column) {
+            const auto& cell = matrix[row][column];
+            const auto route = transport_router.GetRouteInfo(stops[row], stops_to[column]);
+            const auto expected = reference.GetRouteInfo(stops[row], stops_to[column]);
+            assert(cell.has_value() == route.has_value());
+            assert(cell.has_value() == expected.has_value());
+            if (!cell) {
+                continue;
+            }
+            assert(std::abs(cell->first - route->first) <= kTolerance);
+            assert(std::abs(cell->first - expected->first) <= kTolerance);
+            if (with_items) {
+                CheckItems(stops[row], *cell);
+            } else {
+                assert(cell->second.empty());
+            }
+        }
+    }
+}
+
+void TestRouteMatrices() {
+    const std::vector<router::RoutingEngine> engines{
+        router::RoutingEngine::ALL_PAIRS,
+        router::RoutingEngine::DIJKSTRA,
+        router::RoutingEngine::CONTRACTION_HIERARCHY,
+        router::RoutingEngine::ASTAR,
+        router::RoutingEngine::BIDIRECTIONAL_DIJKSTRA,
+        router::RoutingEngine::FIXED_POINT_DIJKSTRA,
+        router::RoutingEngine::HUB_LABELING,
+        router::RoutingEngine::MULTILEVEL_OVERLAY,
+        router::RoutingEngine::COMPACT_ALL_PAIRS,
+    };
+
+    for (const std::string* input : {&test_string, &test_string2, &test_string3}) {
+        RoutingSettings settings{};
+        const TransportCatalogue catalogue = ReadCatalogue(*input, settings);
+        const std::vector<StopPtr> stops = GetStops(catalogue);
+        const router::TransportRouter reference(catalogue, settings);
+        for (const auto model : {router::RouteGraphModel::STOP_TO_STOP, router::RouteGraphModel::ON_BOARD}) {
+            for (const router::RoutingEngine engine : engines) {
+                router::RouterOptions options;
+                options.engine = engine;
+                options.graph_model = model;
+                const router::TransportRouter transport_router(catalogue, settings, options);
+                CheckRouteMatrix(transport_router, reference, stops, false);
+                CheckRouteMatrix(transport_router, reference, stops, true);
+            }
+        }
+
+        const router::TransportRouter transport_router(catalogue, settings);
+        assert(transport_router.GetRouteMatrix({}, stops, true).empty());
+        const auto matrix = transport_router.GetRouteMatrix(stops, {}, true);
+        assert(matrix.size() == stops.size());
+        assert(std::all_of(matrix.begin(), matrix.end(), [](const auto& row) { return row.empty(); }));
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestRouteMatrices();
+    std::cout << "route_matrix_test OK"s << std::endl;
+}
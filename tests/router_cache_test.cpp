@@ -0,0 +1,209 @@
+// a router loaded from its cache file answers like one built anew, and a file whose header doesn't add up
+// to its size or whose table doesn't walk back is built anew instead of read past its end or failing a query;
+// a file that can't be written keeps the router built
+// g++ -std=c++17 -O2 -pthread -I.. router_cache_test.cpp $(ls ../*.cpp | grep -v main.cpp)
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "json_reader.h"
+#include "router_serialization.h"
+#include "test_string.h"
+#include "transport_router.h"
+
+using namespace std::string_literals;
+using namespace transport_catalogue;
+
+namespace {
+
+using router::serialization::FileHeader;
+
+TransportCatalogue ReadCatalogue(const std::string& input, RoutingSettings& settings) {
+    std::istringstream input_stream{input};
+    json_reader::JsonReader reader;
+    reader.ReadJson(input_stream);
+    settings = json_reader::BuildRoutingSettings(reader.GetRoutingSettings());
+    return json_reader::ReadTransportCatalogue(reader.GetBaseRequests());
+}
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream input(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+}
+
+void WriteFile(const std::string& path, const std::string& content) {
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(content.data(), static_cast<std::streamsize>(content.size()));
+    assert(output);
+}
+
+FileHeader ReadHeader(const std::string& content) {
+    FileHeader header{};
+    std::memcpy(&header, content.data(), sizeof(header));
+    return header;
+}
+
+std::string WithHeader(std::string content, const FileHeader& header) {
+    std::memcpy(content.data(), &header, sizeof(header));
+    return content;
+}
+
+class CacheTest {
+public:
+    explicit CacheTest(const std::string& input)
+    : catalogue_(ReadCatalogue(input, settings_))
+    , path_((std::filesystem::temp_directory_path() / "router_cache_test.bin").string())
+    {
+        for (const Stop& stop : catalogue_.GetAllStops()) {
+            stops_.push_back(&stop);
+        }
+    }
+
+    ~CacheTest() {
+        std::filesystem::remove(path_);
+    }
+
+    // builds the router of the engine and writes its cache file, returns the file
+    std::string Save(router::RoutingEngine engine) {
+        std::filesystem::remove(path_);
+        router::TransportRouter(catalogue_, settings_, GetOptions(engine, true));
+        return ReadFile(path_);
+    }
+
+    // a router started over the file answers every two stops like one built without a cache
+    void CheckLoaded(router::RoutingEngine engine, const std::string& content) {
+        WriteFile(path_, content);
+        const router::TransportRouter loaded(catalogue_, settings_, GetOptions(engine, true));
+        const router::TransportRouter built(catalogue_, settings_, GetOptions(engine, false));
+        const auto expected = built.GetRouteMatrix(stops_, stops_, false);
+        for (size_t from = 0; from < stops_.size(); ++from) {
+            for (size_t to = 0; to < stops_.size(); ++to) {
+                const auto route = loaded.GetRouteInfo(stops_[from], stops_[to]);
+                assert(route.has_value() == expected[from][to].has_value());
+                if (route) {
+                    assert(std::abs(route->first - expected[from][to]->first) <= 1e-6);
+                }
+            }
+        }
+    }
+
+private:
+    router::RouterOptions GetOptions(router::RoutingEngine engine, bool has_cache) const {
+        router::RouterOptions options;
+        options.engine = engine;
+        options.route_cache_capacity = 0;
+        if (has_cache) {
+            options.cache_file = path_;
+        }
+        return options;
+    }
+
+    RoutingSettings settings_{};
+    TransportCatalogue catalogue_;
+    std::string path_;
+    std::vector<StopPtr> stops_;
+};
+
+void TestSavedRouters() {
+    for (const router::RoutingEngine engine :
+         {router::RoutingEngine::ALL_PAIRS, router::RoutingEngine::DIJKSTRA,
+          router::RoutingEngine::CONTRACTION_HIERARCHY, router::RoutingEngine::HUB_LABELING,
+          router::RoutingEngine::MULTILEVEL_OVERLAY, router::RoutingEngine::COMPACT_ALL_PAIRS}) {
+        CacheTest test(test_string2);
+        const std::string content = test.Save(engine);
+        assert(content.size() > sizeof(FileHeader));
+        test.CheckLoaded(engine, content);
+    }
+}
+
+// the counts of the header come from the file, so every one of them is checked against its size
+void TestCorruptedHeaders() {
+    const auto engine = router::RoutingEngine::ALL_PAIRS;
+    CacheTest test(test_string2);
+    const std::string content = test.Save(engine);
+    const FileHeader header = ReadHeader(content);
+
+    test.CheckLoaded(engine, content.substr(0, content.size() - 1));
+    test.CheckLoaded(engine, content.substr(0, sizeof(FileHeader)));
+
+    // more edges and as much less engine data: the sizes sum to the file size modulo 2^64
+    FileHeader corrupted = header;
+    const uint64_t extra_edge_count = uint64_t{1} << 60;
+    corrupted.edge_count += extra_edge_count;
+    corrupted.engine_data_size -= extra_edge_count * sizeof(router::serialization::EdgeRecord);
+    test.CheckLoaded(engine, WithHeader(content, corrupted));
+
+    // a vertex count whose square wraps around to the cells of the table
+    corrupted = header;
+    corrupted.vertex_count += uint64_t{1} << 63;
+    test.CheckLoaded(engine, WithHeader(content, corrupted));
+
+    // a graph of many more vertexes than the edges can join
+    const std::string dijkstra_content = test.Save(router::RoutingEngine::DIJKSTRA);
+    corrupted = ReadHeader(dijkstra_content);
+    corrupted.vertex_count = uint64_t{1} << 40;
+    test.CheckLoaded(router::RoutingEngine::DIJKSTRA, WithHeader(dijkstra_content, corrupted));
+}
+
+// the checksum covers the catalogue and the settings, not the table, so a damaged table is caught as it loads
+void TestCorruptedTable() {
+    const auto engine = router::RoutingEngine::ALL_PAIRS;
+    CacheTest test(test_string2);
+    const std::string content = test.Save(engine);
+    const FileHeader header = ReadHeader(content);
+    const size_t prev_edges_size = header.table_cell_count * sizeof(graph::Router<router::Minutes>::PrevEdgeId);
+    assert(content.size() >= sizeof(FileHeader) + header.engine_data_size + prev_edges_size);
+
+    // every route ends with the edge 0, the routes of a stop to itself too
+    std::string corrupted = content;
+    std::memset(corrupted.data() + corrupted.size() - header.engine_data_size - prev_edges_size, 0,
+                prev_edges_size);
+    test.CheckLoaded(engine, corrupted);
+}
+
+// a cache file that can't be written is reported to the log, the router built answers anyway
+void TestUnwritableCache() {
+    RoutingSettings settings{};
+    const TransportCatalogue catalogue = ReadCatalogue(test_string2, settings);
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "router_cache_test_missing";
+    std::filesystem::remove_all(directory);
+
+    std::ostringstream log;
+    router::RouterOptions options;
+    options.cache_file = (directory / "router.bin").string();
+    options.log = &log;
+    const router::TransportRouter transport_router(catalogue, settings, options);
+    assert(log.str().find("can't write the cache file"s) != std::string::npos);
+    assert(!std::filesystem::exists(directory));
+
+    options.cache_file.clear();
+    const router::TransportRouter built(catalogue, settings, options);
+    StopPtr stop_from = &catalogue.GetAllStops().front();
+    StopPtr stop_to = &catalogue.GetAllStops().back();
+    const auto route = transport_router.GetRouteInfo(stop_from, stop_to);
+    const auto expected = built.GetRouteInfo(stop_from, stop_to);
+    assert(route.has_value() == expected.has_value());
+    if (route) {
+        assert(std::abs(route->first - expected->first) <= 1e-6);
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestSavedRouters();
+    TestCorruptedHeaders();
+    TestCorruptedTable();
+    TestUnwritableCache();
+    std::cout << "router_cache_test OK"s << std::endl;
+}
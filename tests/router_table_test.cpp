@@ -0,0 +1,131 @@
+// graph::Router answers from a table it didn't build, and rejects tables whose routes don't walk back
+// as it loads them, before any route is asked for
+// g++ -std=c++17 -O2 -pthread -I.. router_table_test.cpp ../thread_pool.cpp ../min_plus.cpp
+
+#include <cassert>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "router.h"
+#include "test_graphs.h"
+#include "thread_pool.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+using Router = graph::Router<double>;
+
+struct TableCopy {
+    explicit TableCopy(const Router& router)
+    : weights(router.GetTable().weights, router.GetTable().weights + router.GetCellCount())
+    , prev_edges(router.GetTable().prev_edges, router.GetTable().prev_edges + router.GetCellCount())
+    {
+    }
+
+    Router::Table GetTable() const { return {weights.data(), prev_edges.data()}; }
+
+    std::vector<double> weights;
+    std::vector<Router::PrevEdgeId> prev_edges;
+};
+
+// the router checks every row of a table as it loads it, on the pool if there is one
+bool IsRejected(const tests::Graph& graph, const TableCopy& table, concurrency::ThreadPool* thread_pool = nullptr) {
+    try {
+        const Router router(graph, table.GetTable(), thread_pool);
+    } catch (const std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+// the tables of the build and of the updates load
+void TestLoadedTables() {
+    std::mt19937 random(41);
+    std::uniform_int_distribution<int> quarters(0, 40);
+    for (size_t vertex_count : {1, 2, 10, 50}) {
+        for (size_t edge_factor : {0, 1, 3}) {
+            tests::Graph graph = tests::MakeRandomGraph(vertex_count, vertex_count * edge_factor, random);
+            Router router(graph);
+            tests::CheckSameRoutes(graph, router, Router(graph, router.GetTable()));
+
+            if (graph.GetEdgeCount() > 0) {
+                graph.SetEdgeWeight(0, quarters(random) * 0.25);
+                if (router.UpdateEdges({0})) {
+                    const TableCopy table(router);
+                    tests::CheckSameRoutes(graph, Router(graph), Router(graph, table.GetTable()));
+                }
+            }
+        }
+    }
+}
+
+// the first row of a grid: the edges 0 and 1 join the vertexes 0 and 1, the edges 4 and 5 join 1 and 2
+void TestCorruptedTables() {
+    std::mt19937 random(43);
+    const size_t size = 5;
+    const tests::Graph graph = tests::MakeGridGraph(size, random);
+    const TableCopy table(Router{graph});
+    assert(!IsRejected(graph, table));
+
+    TableCopy corrupted = table;
+    corrupted.weights[1] = -1.0;
+    assert(IsRejected(graph, corrupted));
+
+    corrupted = table;
+    corrupted.weights[1] = std::numeric_limits<double>::quiet_NaN();
+    assert(IsRejected(graph, corrupted));
+
+    // an unreachable vertex with an edge into it
+    corrupted = table;
+    corrupted.weights[1] = Router::INFINITE_WEIGHT;
+    assert(IsRejected(graph, corrupted));
+
+    // the route from a vertex to itself has no edges
+    corrupted = table;
+    corrupted.weights[0] = 1.0;
+    assert(IsRejected(graph, corrupted));
+
+    corrupted = table;
+    corrupted.prev_edges[0] = 1;
+    assert(IsRejected(graph, corrupted));
+
+    corrupted = table;
+    corrupted.prev_edges[1] = static_cast<Router::PrevEdgeId>(graph.GetEdgeCount());
+    assert(IsRejected(graph, corrupted));
+
+    // a reachable vertex without an edge into it
+    corrupted = table;
+    corrupted.prev_edges[1] = Router::NO_EDGE;
+    assert(IsRejected(graph, corrupted));
+
+    // an edge into another vertex
+    corrupted = table;
+    corrupted.prev_edges[1] = 4;
+    assert(IsRejected(graph, corrupted));
+
+    // the vertexes 1 and 2 reached from each other
+    corrupted = table;
+    corrupted.prev_edges[1] = 5;
+    corrupted.prev_edges[2] = 4;
+    assert(IsRejected(graph, corrupted));
+
+    // the same in the last row, checked by another task of the pool
+    concurrency::ThreadPool thread_pool(2);
+    assert(!IsRejected(graph, table, &thread_pool));
+    corrupted = table;
+    corrupted.prev_edges[corrupted.prev_edges.size() - 2] = Router::NO_EDGE;
+    assert(IsRejected(graph, corrupted, &thread_pool));
+}
+
+}  // namespace
+
+int main() {
+    TestLoadedTables();
+    TestCorruptedTables();
+    std::cout << "router_table_test OK"s << std::endl;
+}
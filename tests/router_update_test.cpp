@@ -0,0 +1,263 @@
+// the routers updated in place answer like the routers built anew, and rerouting an unknown bus is rejected
+// g++ -std=c++17 -O2 -pthread -I.. router_update_test.cpp $(ls ../*.cpp | grep -v main.cpp)
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "json_reader.h"
+#include "router.h"
+#include "test_graphs.h"
+#include "test_string.h"
+#include "transport_router.h"
+
+using namespace std::string_literals;
+using namespace transport_catalogue;
+
+namespace {
+
+constexpr size_t kMaxOnBoardStopCount = 50;
+
+// reweights, adds and removes edges, then patches the table or, when it declines, builds it anew
+void TestRouterUpdateEdges() {
+    std::mt19937 random(11);
+    std::uniform_int_distribution<int> quarters(0, 40);
+    for (size_t vertex_count : {1, 5, 20, 60}) {
+        tests::Graph graph = tests::MakeRandomGraph(vertex_count, vertex_count * 3, random);
+        std::optional<graph::Router<double>> router;
+        router.emplace(graph);
+        std::uniform_int_distribution<size_t> any_vertex(0, vertex_count - 1);
+
+        for (int round = 0; round < 10; ++round) {
+            std::vector<graph::EdgeId> edge_ids;
+            std::uniform_int_distribution<graph::EdgeId> any_edge(0, graph.GetEdgeCount() - 1);
+            for (int i = 0; i < 3; ++i) {
+                const graph::EdgeId edge_id = any_edge(random);
+                if (!graph.IsEdgeRemoved(edge_id)) {
+                    graph.SetEdgeWeight(edge_id, quarters(random) * 0.25);
+                    edge_ids.push_back(edge_id);
+                }
+            }
+            edge_ids.push_back(graph.AddEdge({any_vertex(random), any_vertex(random), quarters(random) * 0.25}));
+            const graph::EdgeId removed_edge_id = any_edge(random);
+            if (!graph.IsEdgeRemoved(removed_edge_id)) {
+                graph.RemoveEdge(removed_edge_id);
+                edge_ids.push_back(removed_edge_id);
+            }
+
+            if (router->UpdateEdges(edge_ids)) {
+                tests::CheckSameRoutes(graph, graph::Router<double>(graph), *router);
+            } else {
+                router.emplace(graph);
+            }
+        }
+    }
+}
+
+TransportCatalogue ReadCatalogue(const std::string& input, RoutingSettings& settings) {
+    std::istringstream input_stream{input};
+    json_reader::JsonReader reader;
+    reader.ReadJson(input_stream);
+    settings = json_reader::BuildRoutingSettings(reader.GetRoutingSettings());
+    return json_reader::ReadTransportCatalogue(reader.GetBaseRequests());
+}
+
+std::vector<StopPtr> GetStops(const TransportCatalogue& catalogue) {
+    std::vector<StopPtr> stops;
+    for (const Stop& stop : catalogue.GetAllStops()) {
+        stops.push_back(&stop);
+    }
+    return stops;
+}
+
+// the updated router answers every pair of stops like one built anew, also where its route cache
+// held the routes from before the update
+void CheckSameAsRebuilt(const TransportCatalogue& catalogue, const RoutingSettings& settings,
+                        const router::RouterOptions& options, const router::TransportRouter& transport_router) {
+    const std::vector<StopPtr> stops = GetStops(catalogue);
+    const router::TransportRouter rebuilt(catalogue, settings, options);
+    const auto expected = rebuilt.GetRouteMatrix(stops, stops, false);
+    const auto matrix = transport_router.GetRouteMatrix(stops, stops, false);
+    const double tolerance = options.engine == router::RoutingEngine::FIXED_POINT_DIJKSTRA ? 0.05 : 1e-6;
+
+    for (size_t from = 0; from < stops.size(); ++from) {
+        for (size_t to = 0; to < stops.size(); ++to) {
+            const auto route = transport_router.GetRouteInfo(stops[from], stops[to]);
+            assert(route.has_value() == expected[from][to].has_value());
+            assert(matrix[from][to].has_value() == expected[from][to].has_value());
+            if (route) {
+                assert(std::abs(route->first - expected[from][to]->first) <= tolerance);
+                assert(std::abs(matrix[from][to]->first - expected[from][to]->first) <= tolerance);
+            }
+        }
+    }
+}
+
+// fills the route cache, so a stale entry shows up after the update
+void WarmUp(const TransportCatalogue& catalogue, const router::TransportRouter& transport_router) {
+    const std::vector<StopPtr> stops = GetStops(catalogue);
+    for (StopPtr stop_from : stops) {
+        for (StopPtr stop_to : stops) {
+            transport_router.GetRouteInfo(stop_from, stop_to);
+        }
+    }
+}
+
+std::vector<std::string> GetStopNames(const Bus& bus) {
+    std::vector<std::string> names;
+    for (StopPtr stop : bus.stops) {
+        names.push_back(stop->name);
+    }
+    return names;
+}
+
+// the catalogue gives every two consecutive stops a distance
+void AddMissingDistances(TransportCatalogue& catalogue, const std::vector<std::string>& names) {
+    for (size_t i = 1; i < names.size(); ++i) {
+        StopPtr stop_from = catalogue.GetStop(names[i - 1]);
+        StopPtr stop_to = catalogue.GetStop(names[i]);
+        if (!catalogue.ContainsDistanceBetweenStops(stop_from, stop_to) &&
+            !catalogue.ContainsDistanceBetweenStops(stop_to, stop_from)) {
+            catalogue.AddDistancesBetweenStops(stop_from, stop_to, 1000);
+        }
+    }
+}
+
+void TestTransportRouterUpdates(const std::string& input, router::RoutingEngine engine,
+                                router::RouteGraphModel model) {
+    RoutingSettings settings{};
+    TransportCatalogue catalogue = ReadCatalogue(input, settings);
+    router::RouterOptions options;
+    options.engine = engine;
+    options.graph_model = model;
+    router::TransportRouter transport_router(catalogue, settings, options);
+    const std::deque<Bus>& buses = catalogue.GetAllBuses();
+
+    // a distance both shorter and longer
+    for (size_t k = 0; k < 2; ++k) {
+        const Bus& bus = buses[k % buses.size()];
+        if (bus.stops.size() < 2) {
+            continue;
+        }
+        StopPtr stop_from = bus.stops[0];
+        StopPtr stop_to = bus.stops[1];
+        const int distance = catalogue.GetDistanceBetweenStops(stop_from, stop_to);
+        const int new_distance = k == 0 ? std::max(1, distance / 4) : distance * 3 + 100;
+        catalogue.AddDistancesBetweenStops(stop_from, stop_to, new_distance);
+        WarmUp(catalogue, transport_router);
+        transport_router.UpdateDistance(stop_from, stop_to);
+        CheckSameAsRebuilt(catalogue, settings, options, transport_router);
+    }
+
+    // a bus rerouted backwards over the same stops, then over one stop fewer
+    {
+        const Bus& bus = buses.back();
+        std::vector<std::string> names = GetStopNames(bus);
+        std::reverse(names.begin(), names.end());
+        AddMissingDistances(catalogue, names);
+        catalogue.RerouteBus(bus.name, names, bus.is_circular);
+        WarmUp(catalogue, transport_router);
+        transport_router.UpdateBuses({&bus});
+        CheckSameAsRebuilt(catalogue, settings, options, transport_router);
+
+        if (names.size() > 2) {
+            names.pop_back();
+            if (bus.is_circular) {
+                names.back() = names.front();
+            }
+            AddMissingDistances(catalogue, names);
+            catalogue.RerouteBus(bus.name, names, bus.is_circular);
+            transport_router.UpdateBuses({&bus});
+            CheckSameAsRebuilt(catalogue, settings, options, transport_router);
+        }
+    }
+
+    // a new bus from the last stop to the first one, then from a new stop
+    {
+        const std::vector<StopPtr> stops = GetStops(catalogue);
+        const std::vector<std::string> names{stops.back()->name, stops.front()->name};
+        AddMissingDistances(catalogue, names);
+        catalogue.AddBus("Test bus"s, names, false);
+        transport_router.UpdateBuses({catalogue.GetBus("Test bus"s)});
+        CheckSameAsRebuilt(catalogue, settings, options, transport_router);
+
+        catalogue.AddStop("Test stop"s, {55.6, 37.6});
+        const std::vector<std::string> new_names{"Test stop"s, stops.front()->name};
+        AddMissingDistances(catalogue, new_names);
+        catalogue.RerouteBus("Test bus"s, new_names, false);
+        transport_router.UpdateBuses({catalogue.GetBus("Test bus"s)});
+        CheckSameAsRebuilt(catalogue, settings, options, transport_router);
+    }
+
+    settings.wait_time += 2;
+    settings.velocity *= 1.5;
+    WarmUp(catalogue, transport_router);
+    transport_router.UpdateRoutingSettings(settings);
+    CheckSameAsRebuilt(catalogue, settings, options, transport_router);
+}
+
+void TestTransportRouterUpdates() {
+    const std::vector<router::RoutingEngine> engines{
+        router::RoutingEngine::ALL_PAIRS,
+        router::RoutingEngine::DIJKSTRA,
+        router::RoutingEngine::CONTRACTION_HIERARCHY,
+        router::RoutingEngine::ASTAR,
+        router::RoutingEngine::BIDIRECTIONAL_DIJKSTRA,
+        router::RoutingEngine::FIXED_POINT_DIJKSTRA,
+        router::RoutingEngine::HUB_LABELING,
+        router::RoutingEngine::MULTILEVEL_OVERLAY,
+        router::RoutingEngine::COMPACT_ALL_PAIRS,
+    };
+
+    for (const std::string* input : {&test_string, &test_string2, &test_string4}) {
+        RoutingSettings settings{};
+        const size_t stop_count = ReadCatalogue(*input, settings).GetAllStops().size();
+        for (router::RoutingEngine engine : engines) {
+            TestTransportRouterUpdates(*input, engine, router::RouteGraphModel::STOP_TO_STOP);
+            if (stop_count <= kMaxOnBoardStopCount) {
+                TestTransportRouterUpdates(*input, engine, router::RouteGraphModel::ON_BOARD);
+            }
+        }
+    }
+}
+
+// rerouting an unknown bus or through an unknown stop throws and leaves the catalogue as it was
+void TestRerouteUnknown() {
+    RoutingSettings settings{};
+    TransportCatalogue catalogue = ReadCatalogue(test_string, settings);
+    const Bus& bus = catalogue.GetAllBuses().front();
+    const std::vector<StopPtr> stops = bus.stops;
+    const std::set<BusPtr, BusPointerComparator> stop_buses = **catalogue.GetBusesThatPassStop(stops.front());
+    const std::vector<std::string> names{stops.front()->name, stops.back()->name};
+
+    const auto is_rejected = [&catalogue](std::string_view bus_name, const std::vector<std::string>& stop_names) {
+        try {
+            catalogue.RerouteBus(bus_name, stop_names, false);
+        } catch (const std::out_of_range&) {
+            return true;
+        }
+        return false;
+    };
+    assert(is_rejected("No such bus"sv, names));
+    assert(is_rejected(bus.name, {stops.front()->name, "No such stop"s}));
+    assert(bus.stops == stops);
+    assert(**catalogue.GetBusesThatPassStop(stops.front()) == stop_buses);
+}
+
+}  // namespace
+
+int main() {
+    TestRouterUpdateEdges();
+    TestTransportRouterUpdates();
+    TestRerouteUnknown();
+    std::cout << "router_update_test OK"s << std::endl;
+}
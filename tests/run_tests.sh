@@ -0,0 +1,11 @@
+#!/bin/sh
+# builds and runs every test of this directory against the sources of the parent one
+set -e
+cd "$(dirname "$0")"
+sources=$(ls ../*.cpp | grep -v '/main.cpp$')
+build_dir=$(mktemp -d)
+trap 'rm -rf "$build_dir"' EXIT
+for test in *_test.cpp; do
+    g++ -std=c++17 -O2 -Wall -Wextra -pthread -I.. "$test" $sources -o "$build_dir/${test%.cpp}"
+    "$build_dir/${test%.cpp}"
+done
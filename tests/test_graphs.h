@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <optional>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "graph.h"
+#include "router.h"
+
+namespace tests {
+
+using Graph = graph::DirectedWeightedGraph<double>;
+using RouterBase = graph::RouterBase<double>;
+using RouteInfo = RouterBase::RouteInfo;
+
+// weights are whole quarters, so every engine sums them exactly in any order; some edges weigh nothing,
+// some are parallel or loops, and the vertexes past three quarters have no edges into them
+inline Graph MakeRandomGraph(size_t vertex_count, size_t edge_count, std::mt19937& random) {
+    Graph graph(vertex_count);
+    if (vertex_count == 0) {
+        return graph;
+    }
+
+    const size_t reachable_count = std::max<size_t>(1, vertex_count * 3 / 4);
+    std::uniform_int_distribution<size_t> any_vertex(0, vertex_count - 1);
+    std::uniform_int_distribution<size_t> reachable_vertex(0, reachable_count - 1);
+    std::uniform_int_distribution<int> quarters(0, 40);
+    for (size_t i = 0; i < edge_count; ++i) {
+        graph.AddEdge({any_vertex(random), reachable_vertex(random), quarters(random) * 0.25});
+    }
+    return graph;
+}
+
+// two-way streets of a size by size grid: vertex row * size + column has the edges to the right
+// and back first, then the edges down and back
+inline Graph MakeGridGraph(size_t size, std::mt19937& random) {
+    Graph graph(size * size);
+    std::uniform_int_distribution<int> quarters(1, 40);
+    for (size_t row = 0; row < size; ++row) {
+        for (size_t column = 0; column < size; ++column) {
+            const graph::VertexId vertex = row * size + column;
+            if (column + 1 < size) {
+                graph.AddEdge({vertex, vertex + 1, quarters(random) * 0.25});
+                graph.AddEdge({vertex + 1, vertex, quarters(random) * 0.25});
+            }
+            if (row + 1 < size) {
+                graph.AddEdge({vertex, vertex + size, quarters(random) * 0.25});
+                graph.AddEdge({vertex + size, vertex, quarters(random) * 0.25});
+            }
+        }
+    }
+    return graph;
+}
+
+// the edges lead from `from` to `to` in the graph and weigh route.weight
+inline void CheckRoutePath(const Graph& graph, graph::VertexId from, graph::VertexId to, const RouteInfo& route,
+                           double tolerance) {
+    graph::VertexId vertex = from;
+    double weight = 0.0;
+    for (const graph::EdgeId edge_id : route.edges) {
+        assert(edge_id < graph.GetEdgeCount());
+        assert(!graph.IsEdgeRemoved(edge_id));
+        const auto& edge = graph.GetEdge(edge_id);
+        assert(edge.from == vertex);
+        vertex = edge.to;
+        weight += edge.weight;
+    }
+    assert(vertex == to);
+    assert(std::abs(weight - route.weight) <= tolerance);
+}
+
+inline void CheckSameRoute(const Graph& graph, graph::VertexId from, graph::VertexId to,
+                           const std::optional<RouteInfo>& expected,
+                           const std::optional<RouteInfo>& route, double tolerance) {
+    assert(route.has_value() == expected.has_value());
+    if (route) {
+        assert(std::abs(route->weight - expected->weight) <= tolerance);
+        CheckRoutePath(graph, from, to, *route, tolerance);
+    }
+}
+
+// the engine finds a route of the reference's weight between every two vertexes, from == to included,
+// and none where the reference finds none, by BuildRoute and by BuildRoutes
+inline void CheckSameRoutes(const Graph& graph, const RouterBase& reference, const RouterBase& engine,
+                            double tolerance = 0.0) {
+    const size_t vertex_count = graph.GetVertexCount();
+    std::vector<graph::VertexId> targets(vertex_count);
+    for (graph::VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        targets[vertex] = vertex;
+    }
+
+    for (graph::VertexId from = 0; from < vertex_count; ++from) {
+        const auto routes = engine.BuildRoutes(from, targets);
+        assert(routes.size() == vertex_count);
+        for (graph::VertexId to = 0; to < vertex_count; ++to) {
+            const auto expected = reference.BuildRoute(from, to);
+            CheckSameRoute(graph, from, to, expected, engine.BuildRoute(from, to), tolerance);
+            CheckSameRoute(graph, from, to, expected, routes[to], tolerance);
+        }
+    }
+}
+
+// every loopless route from `from` to `to` by a depth-first search, the empty one when they're the same vertex;
+// exponential, for small graphs only
+inline std::vector<RouteInfo> FindLooplessRoutes(const Graph& graph, graph::VertexId from, graph::VertexId to) {
+    std::vector<RouteInfo> routes;
+    std::vector<bool> is_visited(graph.GetVertexCount(), false);
+    RouteInfo route{0.0, {}};
+    const std::function<void(graph::VertexId)> visit = [&](graph::VertexId vertex) {
+        if (vertex == to) {
+            routes.push_back(route);
+            return;
+        }
+        is_visited[vertex] = true;
+        for (const graph::EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            const auto& edge = graph.GetEdge(edge_id);
+            if (is_visited[edge.to]) {
+                continue;
+            }
+            route.weight += edge.weight;
+            route.edges.push_back(edge_id);
+            visit(edge.to);
+            route.edges.pop_back();
+            route.weight -= edge.weight;
+        }
+        is_visited[vertex] = false;
+    };
+    visit(from);
+    return routes;
+}
+
+// the weights and counts of the routes no other loopless route beats both in weight and in the number
+// of counted edges, none counting more than max_count, in the order of their weights; a walk with a loop
+// is never lighter nor counts fewer than the route without the loop, so these are the Pareto set of all walks
+inline std::vector<std::pair<double, size_t>> FindParetoSet(const Graph& graph, graph::VertexId from,
+                                                            graph::VertexId to, const std::vector<bool>& counted_edges,
+                                                            size_t max_count) {
+    std::vector<std::pair<double, size_t>> points;
+    for (const RouteInfo& route : FindLooplessRoutes(graph, from, to)) {
+        const size_t count = std::count_if(route.edges.begin(), route.edges.end(),
+                                           [&counted_edges](graph::EdgeId edge_id) { return counted_edges[edge_id]; });
+        if (count <= max_count) {
+            points.emplace_back(route.weight, count);
+        }
+    }
+    std::sort(points.begin(), points.end());
+
+    std::vector<std::pair<double, size_t>> pareto_set;
+    for (const auto& point : points) {
+        if (pareto_set.empty() || point.second < pareto_set.back().second) {
+            pareto_set.push_back(point);
+        }
+    }
+    return pareto_set;
+}
+
+}  // namespace tests
@@ -0,0 +1,53 @@
+#include "thread_pool.h"
+
+namespace concurrency {
+
+size_t ResolveThreadCount(size_t thread_count) {
+    if (thread_count > 0) {
+        return thread_count;
+    }
+
+    const size_t hardware_threads = std::thread::hardware_concurrency();
+    return hardware_threads > 0 ? hardware_threads : 1;
+}
+
+ThreadPool::ThreadPool(size_t thread_count) : thread_count_(ResolveThreadCount(thread_count)) {
+    if (thread_count_ == 1) {
+        return;
+    }
+
+    workers_.reserve(thread_count_);
+    for (size_t i = 0; i < thread_count_; ++i) {
+        workers_.emplace_back([this] { RunWorker(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    has_task_.notify_all();
+
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::RunWorker() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mutex_);
+            has_task_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        task();
+    }
+}
+
+}  // namespace concurrency
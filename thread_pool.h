@@ -0,0 +1,109 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace concurrency {
+
+// 0 means "as many threads as the hardware supports"
+size_t ResolveThreadCount(size_t thread_count);
+
+class ThreadPool {
+public:
+    // a pool of a single thread doesn't start workers and runs tasks inline in the caller
+    explicit ThreadPool(size_t thread_count = 0);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool();
+
+    size_t GetThreadCount() const { return thread_count_; }
+
+    template <typename Task>
+    std::future<std::invoke_result_t<Task>> Submit(Task task);
+
+    // calls func(index) for every index in [begin, end) and waits for all of them,
+    // rethrows the first exception thrown by func
+    template <typename Func>
+    void ParallelFor(size_t begin, size_t end, Func func);
+
+private:
+    void RunWorker();
+
+    size_t thread_count_;
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable has_task_;
+    bool stopping_ = false;
+};
+
+template <typename Task>
+std::future<std::invoke_result_t<Task>> ThreadPool::Submit(Task task) {
+    using Result = std::invoke_result_t<Task>;
+
+    auto packaged_task = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+    std::future<Result> result = packaged_task->get_future();
+
+    if (workers_.empty()) {
+        (*packaged_task)();
+        return result;
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        tasks_.push([packaged_task] { (*packaged_task)(); });
+    }
+    has_task_.notify_one();
+
+    return result;
+}
+
+template <typename Func>
+void ThreadPool::ParallelFor(size_t begin, size_t end, Func func) {
+    if (begin >= end) {
+        return;
+    }
+
+    if (workers_.empty() || end - begin == 1) {
+        for (size_t index = begin; index < end; ++index) {
+            func(index);
+        }
+        return;
+    }
+
+    std::vector<std::future<void>> results;
+    results.reserve(end - begin);
+    for (size_t index = begin; index < end; ++index) {
+        results.push_back(Submit([&func, index] { func(index); }));
+    }
+    for (auto& result : results) {
+        result.wait();
+    }
+    for (auto& result : results) {
+        result.get();
+    }
+}
+
+// ThreadPool::ParallelFor on the pool, or on the calling thread without one
+template <typename Func>
+void ParallelFor(ThreadPool* thread_pool, size_t begin, size_t end, Func func) {
+    if (thread_pool) {
+        thread_pool->ParallelFor(begin, end, std::move(func));
+        return;
+    }
+    for (size_t index = begin; index < end; ++index) {
+        func(index);
+    }
+}
+
+}  // namespace concurrency
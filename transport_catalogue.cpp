@@ -46,11 +46,48 @@ void TransportCatalogue::AddBus(std::string name, const std::vector<std::string>
     }
 }
 
+void TransportCatalogue::RerouteBus(std::string_view bus_name, const std::vector<std::string>& stop_names,
+                                    bool is_circular) {
+    const auto bus_it = buses_.find(bus_name);
+    if (bus_it == buses_.end()) {
+        throw std::out_of_range("unknown bus "s + std::string(bus_name));
+    }
+    // the index hands out const pointers, the bus itself lives in buses_storage_ owned by the catalogue
+    Bus& bus = const_cast<Bus&>(*bus_it->second);
+
+    // look the new stops up before touching the bus, so it's left as it was when one is unknown
+    std::vector<StopPtr> new_stops;
+    new_stops.reserve(stop_names.size());
+    for (const auto& stop : stop_names) {
+        const auto stop_it = stops_.find(stop);
+        if (stop_it == stops_.end()) {
+            throw std::out_of_range("unknown stop "s + stop);
+        }
+        new_stops.push_back(stop_it->second);
+    }
+
+    // unregister the bus from its old stops, a stop without buses has no entry
+    for (const StopPtr stop : bus.stops) {
+        const auto it = stop_to_buses_.find(stop);
+        if (it != stop_to_buses_.end() && it->second.erase(&bus) > 0 && it->second.empty()) {
+            stop_to_buses_.erase(it);
+        }
+    }
+
+    bus.is_circular = is_circular;
+    bus.stops = std::move(new_stops);
+
+    for (const StopPtr stop : bus.stops) {
+        stop_to_buses_[stop].insert(&bus);
+    }
+}
+
 void TransportCatalogue::AddStop(std::string name, geo::Coordinates coordinates) {
     // create stop
     Stop new_stop;
     new_stop.name = std::move(name);
     new_stop.coordinates = coordinates;
+    new_stop.id = stop_storage_.size();
 
     // add stop to transport catalogue
     stop_storage_.push_back(std::move(new_stop));
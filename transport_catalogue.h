@@ -30,6 +30,10 @@ class TransportCatalogue {
 public:
     void AddBus(std::string name, const std::vector<std::string>& stop_names, bool is_circular);
 
+    // replaces the stops of an existing bus, the bus keeps its address and its place among the buses;
+    // throws std::out_of_range for an unknown bus or stop and leaves the bus as it was
+    void RerouteBus(std::string_view bus_name, const std::vector<std::string>& stop_names, bool is_circular);
+
     void AddStop(std::string name, geo::Coordinates coordinates);
 
     // after all Stops have been added, initialize distances
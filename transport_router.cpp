@@ -1,63 +1,1047 @@
 #include "transport_router.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iterator>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
 namespace transport_catalogue {
 
 using namespace router;
 
+namespace router {
+
+namespace {
+
+// the relative difference of times that only the rounding of their sums makes
+constexpr Minutes kTimeTolerance = 1e-9;
+
+constexpr std::pair<RoutingEngine, std::string_view> kRoutingEngineNames[] = {
+    {RoutingEngine::ALL_PAIRS, "all_pairs"},
+    {RoutingEngine::DIJKSTRA, "dijkstra"},
+    {RoutingEngine::CONTRACTION_HIERARCHY, "contraction_hierarchy"},
+    {RoutingEngine::ASTAR, "astar"},
+    {RoutingEngine::BIDIRECTIONAL_DIJKSTRA, "bidirectional_dijkstra"},
+    {RoutingEngine::FIXED_POINT_DIJKSTRA, "fixed_point_dijkstra"},
+    {RoutingEngine::HUB_LABELING, "hub_labeling"},
+    {RoutingEngine::MULTILEVEL_OVERLAY, "multilevel_overlay"},
+    {RoutingEngine::COMPACT_ALL_PAIRS, "compact_all_pairs"},
+    {RoutingEngine::AUTO, "auto"},
+};
+
+}  // namespace
+
+std::string_view GetRoutingEngineName(RoutingEngine engine) {
+    for (const auto& [known_engine, name] : kRoutingEngineNames) {
+        if (known_engine == engine) {
+            return name;
+        }
+    }
+    throw std::logic_error("unsupported routing engine"s);
+}
+
+std::optional<RoutingEngine> ParseRoutingEngine(std::string_view name) {
+    for (const auto& [engine, known_name] : kRoutingEngineNames) {
+        if (known_name == name) {
+            return engine;
+        }
+    }
+    return std::nullopt;
+}
+
+}  // namespace router
+
 TransportRouter::TransportRouter(const transport_catalogue::TransportCatalogue& catalogue,
-                                 const RoutingSettings& settings)
-    : catalogue_(catalogue), settings_(settings) {
-    graph_ = graph::DirectedWeightedGraph<Minutes>(CreateVertexes(catalogue.GetAllStops()));
-    CreateEdges(catalogue);
-    router_ = std::make_unique<graph::Router<Minutes>>(graph_);
+                                 const RoutingSettings& settings, const RouterOptions& options)
+    : catalogue_(catalogue),
+      settings_(settings),
+      options_(options),
+      thread_pool_(std::make_unique<concurrency::ThreadPool>(options.thread_count)) {
+    // the graph is cheap next to any engine, so AUTO picks by the size of the graph itself; the cache file
+    // records the engine picked, which the same catalogue picks again
+    bool is_graph_built = false;
+    if (options_.engine == RoutingEngine::AUTO) {
+        BuildGraph();
+        is_graph_built = true;
+        options_.engine = ChooseEngine(graph_.GetVertexCount(), graph_.GetEdgeCount(), options_);
+    }
+
+    if (options_.cache_file.empty() || !LoadFromFile(options_)) {
+        if (!is_graph_built) {
+            BuildGraph();
+        }
+        router_ = CreateRouter(options_);
+
+        // the cache only saves the next start the build, the router built is kept when it can't be written
+        if (!options_.cache_file.empty() && !SaveToFile(options_) && options_.log) {
+            *options_.log << "router: can't write the cache file " << options_.cache_file << '\n';
+        }
+    }
+
+    if (options_.route_cache_capacity > 0 && options_.engine != RoutingEngine::ALL_PAIRS &&
+        options_.engine != RoutingEngine::COMPACT_ALL_PAIRS) {
+        route_cache_ = std::make_unique<RouteCache>(options.route_cache_capacity);
+    }
+}
+
+void TransportRouter::UpdateBuses(const std::vector<BusPtr>& buses) {
+    if (route_cache_) {
+        route_cache_->Clear();
+    }
+
+    // the stops the graph was built for, against the ones the catalogue has now
+    if (catalogue_.GetAllStops().size() != stop_count_) {
+        Rebuild();
+        return;
+    }
+
+    std::unordered_set<const char*> bus_names;
+    for (const BusPtr bus : buses) {
+        bus_names.insert(bus->name.data());
+    }
+
+    // the rides of the buses, and the on-board vertexes they join in the on-board model
+    std::vector<graph::EdgeId> current_edge_ids;
+    std::unordered_map<const char*, std::pair<graph::VertexId, graph::VertexId>> on_board_ranges;
+    for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        const auto* ride_info = std::get_if<BusRideInfo>(&edge_items_[edge_id]);
+        if (graph_.IsEdgeRemoved(edge_id) || !ride_info || bus_names.count(ride_info->bus_name.data()) == 0) {
+            continue;
+        }
+        current_edge_ids.push_back(edge_id);
+        if (options_.graph_model == RouteGraphModel::ON_BOARD) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            auto it = on_board_ranges.emplace(ride_info->bus_name.data(), std::pair{edge.from, edge.to}).first;
+            it->second = {std::min({it->second.first, edge.from, edge.to}),
+                          std::max({it->second.second, edge.from, edge.to})};
+        }
+    }
+
+    // the boarding and alighting edges of those on-board vertexes
+    if (options_.graph_model == RouteGraphModel::ON_BOARD) {
+        std::vector<bool> is_bus_vertex(graph_.GetVertexCount(), false);
+        for (const auto& [bus_name, range] : on_board_ranges) {
+            std::fill(is_bus_vertex.begin() + range.first, is_bus_vertex.begin() + range.second + 1, true);
+        }
+        for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            if (!graph_.IsEdgeRemoved(edge_id) && std::holds_alternative<std::monostate>(edge_items_[edge_id]) &&
+                (is_bus_vertex[edge.from] || is_bus_vertex[edge.to])) {
+                current_edge_ids.push_back(edge_id);
+            }
+        }
+    }
+
+    // the edges the buses give now are built aside, a bus in the on-board model takes its own on-board vertexes
+    // again, which needs the same number of them
+    graph::DirectedWeightedGraph<Minutes> graph(graph_.GetVertexCount());
+    std::vector<RouteItem> edge_items;
+    std::swap(graph, graph_);
+    std::swap(edge_items, edge_items_);
+    const graph::VertexId vertexes_counter = vertexes_counter_;
+    bool is_rebuild_needed = false;
+    for (const BusPtr bus : buses) {
+        if (options_.graph_model == RouteGraphModel::ON_BOARD && bus->stops.size() > 1) {
+            const auto it = on_board_ranges.find(bus->name.data());
+            if (it == on_board_ranges.end() ||
+                it->second.second - it->second.first + 1 != CountOnBoardVertexes(*bus)) {
+                is_rebuild_needed = true;
+                break;
+            }
+            vertexes_counter_ = it->second.first;
+        }
+        ConnectBus(*bus, options_.graph_model);
+    }
+    vertexes_counter_ = vertexes_counter;
+    std::swap(graph, graph_);
+    std::swap(edge_items, edge_items_);
+
+    if (is_rebuild_needed) {
+        Rebuild();
+        return;
+    }
+
+    const std::vector<graph::EdgeId> changed_edges = PatchEdges(current_edge_ids, graph, edge_items);
+    if (changed_edges.empty()) {
+        return;
+    }
+    if (!router_->UpdateEdges(changed_edges)) {
+        router_ = CreateRouter(options_);
+    }
+    // the router doesn't use a loaded table after the update
+    mapped_file_.reset();
+    graph_searches_.reset();
+}
+
+void TransportRouter::UpdateDistance(StopPtr stop_from, StopPtr stop_to) {
+    const auto buses_from = catalogue_.GetBusesThatPassStop(stop_from);
+    const auto buses_to = catalogue_.GetBusesThatPassStop(stop_to);
+    if (!buses_from || !buses_to) {
+        return;
+    }
+
+    std::vector<BusPtr> buses;
+    std::set_intersection((*buses_from)->begin(), (*buses_from)->end(), (*buses_to)->begin(), (*buses_to)->end(),
+                          std::back_inserter(buses), BusPointerComparator{});
+    UpdateBuses(buses);
+}
+
+void TransportRouter::UpdateRoutingSettings(const RoutingSettings& settings) {
+    if (route_cache_) {
+        route_cache_->Clear();
+    }
+
+    settings_ = settings;
+    graph::DirectedWeightedGraph<Minutes> graph;
+    std::swap(graph, graph_);
+    BuildGraph();
+
+    // the edges match by id if the graph is built from the same buses and stops and wasn't patched
+    bool is_same_graph =
+        graph.GetVertexCount() == graph_.GetVertexCount() && graph.GetEdgeCount() == graph_.GetEdgeCount();
+    std::vector<graph::EdgeId> changed_edges;
+    for (graph::EdgeId edge_id = 0; is_same_graph && edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        const auto& old_edge = graph.GetEdge(edge_id);
+        is_same_graph = !graph.IsEdgeRemoved(edge_id) && edge.from == old_edge.from && edge.to == old_edge.to;
+        if (edge.weight != old_edge.weight) {
+            changed_edges.push_back(edge_id);
+        }
+    }
+
+    if (is_same_graph && changed_edges.empty()) {
+        return;
+    }
+    if (!is_same_graph || !router_->UpdateEdges(changed_edges)) {
+        router_ = CreateRouter(options_);
+    }
+    // the router doesn't use a loaded table after the update
+    mapped_file_.reset();
+    graph_searches_.reset();
 }
 
 std::optional<std::pair<Minutes, std::vector<TransportRouter::RouteItem>>> TransportRouter::GetRouteInfo(
     StopPtr stop_from, StopPtr stop_to) const {
-    graph::VertexId from_vertex = vertexes_.at(stop_from->name).in;
+    if (!route_cache_) {
+        return FindRoute(stop_from, stop_to);
+    }
 
-    graph::VertexId to_vertex = vertexes_.at(stop_to->name).in;
+    const std::pair stops{stop_from, stop_to};
+    if (const auto cached_route = route_cache_->Get(stops)) {
+        return **cached_route;
+    }
+    auto route = std::make_shared<const std::optional<Route>>(FindRoute(stop_from, stop_to));
+    route_cache_->Put(stops, route);
+    return *route;
+}
+
+concurrency::CacheStats TransportRouter::GetRouteCacheStats() const {
+    return route_cache_ ? route_cache_->GetStats() : concurrency::CacheStats{};
+}
 
-    std::optional<graph::Router<Minutes>::RouteInfo> route_info = router_->BuildRoute(from_vertex, to_vertex);
+std::optional<TransportRouter::Route> TransportRouter::FindRoute(StopPtr stop_from, StopPtr stop_to) const {
+    graph::VertexId from_vertex = GetStopVertexes(stop_from).in;
+
+    graph::VertexId to_vertex = GetStopVertexes(stop_to).in;
+
+    std::optional<graph::RouterBase<Minutes>::RouteInfo> route_info = router_->BuildRoute(from_vertex, to_vertex);
 
     if (!route_info) {
         return {};
     }
 
-    std::pair<Minutes, std::vector<RouteItem>> output;
-    output.first = route_info->weight;
+    if (options_.graph_model == RouteGraphModel::ON_BOARD) {
+        return PickStopToStopRoute(FindFastestEdges(stop_from, route_info->weight), stop_to);
+    }
+
+    return UnpackRoute(*route_info);
+}
+
+TransportRouter::RouteMatrix TransportRouter::GetRouteMatrix(const std::vector<StopPtr>& stops_from,
+                                                             const std::vector<StopPtr>& stops_to,
+                                                             bool with_items) const {
+    std::vector<graph::VertexId> targets;
+    targets.reserve(stops_to.size());
+    for (const StopPtr stop_to : stops_to) {
+        targets.push_back(GetStopVertexes(stop_to).in);
+    }
+
+    RouteMatrix matrix(stops_from.size());
+    thread_pool_->ParallelFor(0, stops_from.size(), [&](size_t row) {
+        std::vector<std::optional<graph::RouterBase<Minutes>::RouteInfo>> route_infos =
+            router_->BuildRoutes(GetStopVertexes(stops_from[row]).in, targets);
+
+        // one search of the on-board graph picks the routes of the whole row
+        std::optional<FastestEdges> fastest_edges;
+        if (options_.graph_model == RouteGraphModel::ON_BOARD) {
+            Minutes max_time{};
+            for (const auto& route_info : route_infos) {
+                if (route_info) {
+                    max_time = std::max(max_time, route_info->weight);
+                }
+            }
+            fastest_edges = FindFastestEdges(stops_from[row], max_time);
+        }
+
+        matrix[row].reserve(route_infos.size());
+        for (size_t column = 0; column < route_infos.size(); ++column) {
+            const auto& route_info = route_infos[column];
+            if (!route_info) {
+                matrix[row].emplace_back();
+                continue;
+            }
+            Route route = fastest_edges ? *PickStopToStopRoute(*fastest_edges, stops_to[column])
+                                        : UnpackRoute(*route_info);
+            if (!with_items) {
+                route.second.clear();
+                route.second.shrink_to_fit();
+            }
+            matrix[row].push_back(std::move(route));
+        }
+    });
+
+    return matrix;
+}
+
+std::vector<TransportRouter::Route> TransportRouter::GetAlternativeRoutes(StopPtr stop_from, StopPtr stop_to,
+                                                                         size_t alternative_count,
+                                                                         Minutes max_time_gap) const {
+    std::vector<Route> routes;
+    for (const auto& route_info :
+         GetGraphSearches().k_shortest_paths.FindRoutes(GetStopVertexes(stop_from).in, GetStopVertexes(stop_to).in,
+                                                        alternative_count + 1, max_time_gap, *thread_pool_)) {
+        routes.push_back(UnpackRoute(route_info));
+    }
+
+    return routes;
+}
+
+std::vector<TransportRouter::Route> TransportRouter::GetParetoRoutes(StopPtr stop_from, StopPtr stop_to,
+                                                                    size_t max_boardings) const {
+    std::vector<Route> routes;
+    for (auto& pareto_route :
+         GetGraphSearches().pareto_search.FindRoutes(GetStopVertexes(stop_from).in, GetStopVertexes(stop_to).in,
+                                                     max_boardings)) {
+        routes.push_back(UnpackRoute({pareto_route.weight, std::move(pareto_route.edges)}));
+    }
+
+    return routes;
+}
+
+std::vector<TransportRouter::ReachableStop> TransportRouter::GetIsochrone(StopPtr stop, Minutes max_time,
+                                                                         IsochroneDirection direction) const {
+    using Direction = graph::BoundedSearch<Minutes>::Direction;
+
+    const std::deque<Stop>& stops = catalogue_.GetAllStops();
+
+    const Direction search_direction =
+        direction == IsochroneDirection::FROM_STOP ? Direction::FORWARD : Direction::BACKWARD;
+
+    std::vector<ReachableStop> reachable_stops;
+    for (const auto& [vertex, time] :
+         GetGraphSearches().bounded_search.Search(GetStopVertexes(stop).in, max_time, search_direction)) {
+        // routes start and end at the in vertexes of the stops, which take the even ids below the on-board ones
+        if (vertex < 2 * stop_count_ && vertex % 2 == 0) {
+            reachable_stops.push_back({stops[vertex / 2].name, time});
+        }
+    }
+
+    return reachable_stops;
+}
+
+TransportRouter::Route TransportRouter::UnpackRoute(const graph::RouterBase<Minutes>::RouteInfo& route_info) const {
+    Route output;
 
     auto& items = output.second;
 
-    for (const auto& edge_id : route_info->edges) {
-        if (bus_edges_.count(edge_id) > 0) {
-            items.push_back(bus_edges_.at(edge_id));
+    // every engine weighs its route by the original weights, the fixed-point one too; the on-board model
+    // splits a ride into segments, so its total is summed item by item, which may differ from the stop-to-stop
+    // total in the last digits: its shortest routes are taken from PickStopToStopRoute instead
+    const bool is_total_summed = options_.graph_model == RouteGraphModel::ON_BOARD;
+    Minutes& total_time = output.first;
+    total_time = is_total_summed ? Minutes{} : route_info.weight;
 
-        } else if (wait_edges_.count(edge_id) > 0) {
-            items.push_back(wait_edges_.at(edge_id));
+    // consecutive ride edges of the on-board model make up one ride, the next wait ends it
+    std::optional<BusRideInfo> ride;
+    auto finish_ride = [&] {
+        if (ride) {
+            if (is_total_summed) {
+                total_time += ride->time;
+            }
+            items.push_back(*std::exchange(ride, std::nullopt));
+        }
+    };
+
+    for (const auto& edge_id : route_info.edges) {
+        const RouteItem& edge_item = edge_items_[edge_id];
+        if (const auto* segment = std::get_if<BusRideInfo>(&edge_item)) {
+            if (ride) {
+                ride->span_count += segment->span_count;
+                ride->time += segment->time;
+            } else {
+                ride = *segment;
+            }
+
+        } else if (const auto* wait = std::get_if<WaitInfo>(&edge_item)) {
+            finish_ride();
+            if (is_total_summed) {
+                total_time += wait->time;
+            }
+            items.push_back(*wait);
 
         } else {
-            assert(false);
+            // boarding and alighting are free and make no item
+            assert(graph_.GetEdge(edge_id).weight == kZeroWaitTime);
         }
     }
+    finish_ride();
 
-    return {std::move(output)};
+    return output;
 }
 
-size_t TransportRouter::CreateVertexes(const std::deque<Stop>& stops) {
-    for (const Stop& stop : stops) {
-        vertexes_[stop.name].in = GenereateNewVertexId();
-        vertexes_[stop.name].out = GenereateNewVertexId();
+TransportRouter::FastestEdges TransportRouter::FindFastestEdges(StopPtr stop_from, Minutes max_time) const {
+    using Direction = graph::BoundedSearch<Minutes>::Direction;
+
+    const GraphSearches& graph_searches = GetGraphSearches();
+    const graph::CsrGraph<Minutes>& graph = graph_searches.forward_graph;
+
+    // the times of the search and of the sums of the stop-to-stop model differ by the rounding only
+    const Minutes tolerance = max_time * kTimeTolerance;
+    std::unordered_map<graph::VertexId, Minutes> times;
+    for (const auto& [vertex, time] : graph_searches.bounded_search.Search(GetStopVertexes(stop_from).in,
+                                                                           max_time + tolerance, Direction::FORWARD)) {
+        times.emplace(vertex, time);
+    }
+    const auto is_fastest = [&times, tolerance](graph::VertexId from, Minutes weight, graph::VertexId to) {
+        const auto it = times.find(to);
+        return it != times.end() && times.at(from) + weight <= it->second + tolerance;
+    };
+
+    // the stop-to-stop model adds the waits first and the rides in the order of their on-board vertexes
+    using EdgeOrder = std::pair<graph::VertexId, graph::VertexId>;
+    std::vector<std::pair<EdgeOrder, StopToStopEdge>> ordered_edges;
+    for (const auto& [vertex, time] : times) {
+        if (vertex >= 2 * stop_count_) {
+            continue;
+        }
+        if (vertex % 2 == 0) {
+            for (const auto& arc : graph.GetArcs(vertex)) {
+                const auto* wait = std::get_if<WaitInfo>(&edge_items_[arc.edge_id]);
+                if (wait && is_fastest(vertex, arc.weight, arc.to)) {
+                    ordered_edges.push_back({{vertex, arc.to}, {vertex, arc.to, arc.weight, *wait}});
+                }
+            }
+            continue;
+        }
+
+        // a ride is summed segment by segment from the boarding, as the stop-to-stop model sums it, and goes
+        // on while it is the fastest way to its on-board vertex
+        for (const auto& boarding : graph.GetArcs(vertex)) {
+            BusRideInfo ride{};
+            graph::VertexId on_board = boarding.to;
+            for (bool is_ride_fastest = true; is_ride_fastest;) {
+                is_ride_fastest = false;
+                for (const auto& segment : graph.GetArcs(on_board)) {
+                    const auto* segment_info = std::get_if<BusRideInfo>(&edge_items_[segment.edge_id]);
+                    if (!segment_info) {
+                        continue;
+                    }
+                    ride.bus_name = segment_info->bus_name;
+                    ride.time += segment.weight;
+                    ++ride.span_count;
+                    on_board = segment.to;
+                    is_ride_fastest = is_fastest(vertex, ride.time, on_board);
+                    break;
+                }
+                if (!is_ride_fastest) {
+                    break;
+                }
+                for (const auto& alighting : graph.GetArcs(on_board)) {
+                    if (alighting.to < 2 * stop_count_ && is_fastest(vertex, ride.time, alighting.to)) {
+                        ordered_edges.push_back({{boarding.to, on_board}, {vertex, alighting.to, ride.time, ride}});
+                    }
+                }
+            }
+        }
+    }
+    std::sort(ordered_edges.begin(), ordered_edges.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+    FastestEdges fastest_edges;
+    fastest_edges.from = GetStopVertexes(stop_from).in;
+    fastest_edges.edges.reserve(ordered_edges.size());
+    for (auto& [order, edge] : ordered_edges) {
+        fastest_edges.incoming_edges[edge.to].push_back(fastest_edges.edges.size());
+        fastest_edges.edges.push_back(std::move(edge));
+    }
+    return fastest_edges;
+}
+
+std::optional<TransportRouter::Route> TransportRouter::PickStopToStopRoute(const FastestEdges& fastest_edges,
+                                                                         StopPtr stop_to) const {
+    const std::vector<StopToStopEdge>& edges = fastest_edges.edges;
+    const graph::VertexId vertex_from = fastest_edges.from;
+    const graph::VertexId vertex_to = GetStopVertexes(stop_to).in;
+
+    // the fastest routes to the stop, found back from it; the table picks among them as it picks in the
+    // whole graph, as every route it compares them with is slower
+    std::vector<graph::VertexId> vertexes{vertex_from, vertex_to};
+    std::vector<bool> is_route_edge(edges.size(), false);
+    std::unordered_set<graph::VertexId> visited_vertexes{vertex_to};
+    std::vector<graph::VertexId> vertexes_to_visit{vertex_to};
+    while (!vertexes_to_visit.empty()) {
+        const graph::VertexId vertex = vertexes_to_visit.back();
+        vertexes_to_visit.pop_back();
+        const auto it = fastest_edges.incoming_edges.find(vertex);
+        if (it == fastest_edges.incoming_edges.end()) {
+            continue;
+        }
+        for (const size_t edge_index : it->second) {
+            is_route_edge[edge_index] = true;
+            if (visited_vertexes.insert(edges[edge_index].from).second) {
+                vertexes_to_visit.push_back(edges[edge_index].from);
+                vertexes.push_back(edges[edge_index].from);
+            }
+        }
+    }
+    std::sort(vertexes.begin(), vertexes.end());
+    vertexes.erase(std::unique(vertexes.begin(), vertexes.end()), vertexes.end());
+    const auto get_index = [&vertexes](graph::VertexId vertex) {
+        return static_cast<size_t>(std::lower_bound(vertexes.begin(), vertexes.end(), vertex) - vertexes.begin());
+    };
+
+    // Floyd-Warshall as the all-pairs table runs it: the vertexes in the order of their ids,
+    // the first of the lightest parallel edges, and a route replaced only by a strictly lighter one
+    struct RouteData {
+        Minutes weight{};
+        std::optional<size_t> prev_edge;
+    };
+    const size_t vertex_count = vertexes.size();
+    std::vector<std::optional<RouteData>> routes(vertex_count * vertex_count);
+    for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        routes[vertex * vertex_count + vertex] = RouteData{};
+    }
+    for (size_t edge_index = 0; edge_index < edges.size(); ++edge_index) {
+        if (!is_route_edge[edge_index]) {
+            continue;
+        }
+        const StopToStopEdge& edge = edges[edge_index];
+        auto& route = routes[get_index(edge.from) * vertex_count + get_index(edge.to)];
+        if (!route || route->weight > edge.weight) {
+            route = RouteData{edge.weight, edge_index};
+        }
+    }
+    for (size_t vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
+        for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+            const std::optional<RouteData> route_from = routes[vertex * vertex_count + vertex_through];
+            if (!route_from) {
+                continue;
+            }
+            for (size_t vertex_next = 0; vertex_next < vertex_count; ++vertex_next) {
+                const auto& route_to = routes[vertex_through * vertex_count + vertex_next];
+                if (!route_to) {
+                    continue;
+                }
+                auto& route = routes[vertex * vertex_count + vertex_next];
+                const Minutes weight = route_from->weight + route_to->weight;
+                if (!route || weight < route->weight) {
+                    route = RouteData{weight, route_to->prev_edge ? route_to->prev_edge : route_from->prev_edge};
+                }
+            }
+        }
+    }
+
+    const size_t index_from = get_index(vertex_from);
+    const auto& route = routes[index_from * vertex_count + get_index(vertex_to)];
+    if (!route) {
+        return std::nullopt;
+    }
+    std::vector<size_t> route_edges;
+    for (std::optional<size_t> edge_index = route->prev_edge; edge_index;
+         edge_index = routes[index_from * vertex_count + get_index(edges[*edge_index].from)]->prev_edge) {
+        route_edges.push_back(*edge_index);
+    }
+
+    Route output{route->weight, {}};
+    for (auto it = route_edges.rbegin(); it != route_edges.rend(); ++it) {
+        output.second.push_back(edges[*it].item);
+    }
+    return output;
+}
+
+void TransportRouter::BuildGraph() {
+    stop_count_ = catalogue_.GetAllStops().size();
+    graph_ = graph::DirectedWeightedGraph<Minutes>(CreateVertexes(catalogue_, options_.graph_model));
+    edge_items_.clear();
+    CreateEdges(catalogue_, options_.graph_model);
+}
+
+void TransportRouter::Rebuild() {
+    BuildGraph();
+    router_ = CreateRouter(options_);
+    mapped_file_.reset();
+    graph_searches_.reset();
+}
+
+TransportRouter::GraphSearches::GraphSearches(const graph::DirectedWeightedGraph<Minutes>& graph,
+                                              const std::vector<RouteItem>& edge_items)
+    : forward_graph(graph, graph::CsrGraph<Minutes>::Direction::FORWARD),
+      backward_graph(graph, graph::CsrGraph<Minutes>::Direction::BACKWARD),
+      boarding_edges(graph.GetEdgeCount(), false),
+      bounded_search(forward_graph, backward_graph),
+      k_shortest_paths(graph, forward_graph, backward_graph),
+      pareto_search(forward_graph, backward_graph, boarding_edges) {
+    for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        boarding_edges[edge_id] = std::holds_alternative<WaitInfo>(edge_items[edge_id]);
+    }
+}
+
+const TransportRouter::GraphSearches& TransportRouter::GetGraphSearches() const {
+    std::lock_guard lock(graph_searches_mutex_);
+    if (!graph_searches_) {
+        graph_searches_ = std::make_unique<const GraphSearches>(graph_, edge_items_);
+    }
+    return *graph_searches_;
+}
+
+std::vector<graph::EdgeId> TransportRouter::PatchEdges(const std::vector<graph::EdgeId>& current_edge_ids,
+                                                       const graph::DirectedWeightedGraph<Minutes>& graph,
+                                                       const std::vector<RouteItem>& edge_items) {
+    // edges are the same if they join the same vertexes for the same item: nothing or a ride of the same bus
+    // over the same number of stops; the bus names of both graphs point into the catalogue
+    using EdgeKey = std::tuple<graph::VertexId, graph::VertexId, const char*, int>;
+    using KeyedEdge = std::pair<EdgeKey, graph::EdgeId>;
+    const auto get_keyed_edge = [](const graph::Edge<Minutes>& edge, const RouteItem& item, graph::EdgeId edge_id) {
+        const auto* ride_info = std::get_if<BusRideInfo>(&item);
+        return KeyedEdge{ride_info ? EdgeKey{edge.from, edge.to, ride_info->bus_name.data(), ride_info->span_count}
+                                   : EdgeKey{edge.from, edge.to, nullptr, 0},
+                         edge_id};
+    };
+
+    std::vector<KeyedEdge> current_edges;
+    current_edges.reserve(current_edge_ids.size());
+    for (const graph::EdgeId edge_id : current_edge_ids) {
+        current_edges.push_back(get_keyed_edge(graph_.GetEdge(edge_id), edge_items_[edge_id], edge_id));
+    }
+    std::vector<KeyedEdge> new_edges;
+    new_edges.reserve(graph.GetEdgeCount());
+    for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        new_edges.push_back(get_keyed_edge(graph.GetEdge(edge_id), edge_items[edge_id], edge_id));
+    }
+    // the same edges can repeat on a bus that passes a stop twice, they are matched in the order of ids
+    std::sort(current_edges.begin(), current_edges.end());
+    std::sort(new_edges.begin(), new_edges.end());
+
+    std::vector<graph::EdgeId> changed_edges;
+    auto current_it = current_edges.begin();
+    auto new_it = new_edges.begin();
+    while (current_it != current_edges.end() || new_it != new_edges.end()) {
+        if (new_it == new_edges.end() || (current_it != current_edges.end() && current_it->first < new_it->first)) {
+            graph_.RemoveEdge(current_it->second);
+            changed_edges.push_back(current_it->second);
+            ++current_it;
+        } else if (current_it == current_edges.end() || new_it->first < current_it->first) {
+            changed_edges.push_back(AddEdge(graph.GetEdge(new_it->second), edge_items[new_it->second]));
+            ++new_it;
+        } else {
+            const Minutes weight = graph.GetEdge(new_it->second).weight;
+            if (graph_.GetEdge(current_it->second).weight != weight) {
+                graph_.SetEdgeWeight(current_it->second, weight);
+                edge_items_[current_it->second] = edge_items[new_it->second];
+                changed_edges.push_back(current_it->second);
+            }
+            ++current_it;
+            ++new_it;
+        }
+    }
+
+    return changed_edges;
+}
+
+RoutingEngine TransportRouter::ChooseEngine(size_t vertex_count, size_t edge_count, const RouterOptions& options) {
+    // rates measured on one core; a hierarchy keeps about two shortcuts per edge, its build rate varies
+    // with the shape of the graph by up to ten times
+    constexpr double kFloydWarshallStepsPerSecond = 2.8e9;
+    constexpr double kDijkstraStepsPerSecond = 4e7;
+    constexpr double kHierarchyStepsPerSecond = 2e6;
+    constexpr double kHierarchyBytesPerEdge = 3 * 48.0;
+    constexpr double kHierarchyBytesPerVertex = 64.0;
+
+    const double vertexes = static_cast<double>(vertex_count);
+    const double edges = static_cast<double>(edge_count);
+    const double all_pairs_bytes =
+        vertexes * vertexes * (sizeof(Minutes) + sizeof(graph::Router<Minutes>::PrevEdgeId));
+    const double all_pairs_seconds = vertexes * vertexes * vertexes / kFloydWarshallStepsPerSecond;
+    const double compact_bytes =
+        vertexes * vertexes * (edge_count < UINT16_MAX ? sizeof(uint16_t) : sizeof(uint32_t));
+    const double compact_steps = vertexes * (edges + vertexes * std::log2(vertexes + 1.0));
+    const double compact_seconds = compact_steps / kDijkstraStepsPerSecond;
+    const double hierarchy_bytes = edges * kHierarchyBytesPerEdge + vertexes * kHierarchyBytesPerVertex;
+    const double hierarchy_seconds = vertexes * edges / kHierarchyStepsPerSecond;
+    const double memory_budget = static_cast<double>(options.memory_budget);
+
+    RoutingEngine engine = RoutingEngine::DIJKSTRA;
+    if (all_pairs_bytes <= memory_budget && all_pairs_seconds <= options.build_time_budget) {
+        engine = RoutingEngine::ALL_PAIRS;
+    } else if (compact_bytes <= memory_budget && compact_seconds <= options.build_time_budget) {
+        engine = RoutingEngine::COMPACT_ALL_PAIRS;
+    } else if (hierarchy_bytes <= memory_budget && hierarchy_seconds <= options.build_time_budget) {
+        engine = RoutingEngine::CONTRACTION_HIERARCHY;
+    }
+
+    if (options.log) {
+        *options.log << "router: " << vertex_count << " vertexes, " << edge_count << " edges, all-pairs table "
+                     << all_pairs_bytes << " bytes in about " << all_pairs_seconds << " s, compact all-pairs table "
+                     << compact_bytes << " bytes in about " << compact_seconds << " s, contraction hierarchy "
+                     << hierarchy_bytes << " bytes in about " << hierarchy_seconds << " s, memory budget "
+                     << options.memory_budget << " bytes, build time budget " << options.build_time_budget
+                     << " s: " << GetRoutingEngineName(engine) << '\n';
+    }
+    return engine;
+}
+
+std::unique_ptr<graph::RouterBase<Minutes>> TransportRouter::CreateRouter(const RouterOptions& options) const {
+    switch (options.engine) {
+        case RoutingEngine::ALL_PAIRS:
+            return std::make_unique<graph::Router<Minutes>>(graph_, thread_pool_.get());
+        case RoutingEngine::DIJKSTRA:
+            return std::make_unique<graph::DijkstraRouter<Minutes>>(graph_);
+        case RoutingEngine::CONTRACTION_HIERARCHY:
+            return std::make_unique<graph::ContractionHierarchyRouter<Minutes>>(graph_, thread_pool_.get());
+        case RoutingEngine::ASTAR:
+            return std::make_unique<graph::AStarRouter<Minutes>>(graph_, CreateGeoLowerBound());
+        case RoutingEngine::BIDIRECTIONAL_DIJKSTRA:
+            return std::make_unique<graph::BidirectionalDijkstraRouter<Minutes>>(graph_);
+        case RoutingEngine::FIXED_POINT_DIJKSTRA:
+            return std::make_unique<graph::FixedPointRouter<Minutes>>(graph_, kFixedPointUnit);
+        case RoutingEngine::HUB_LABELING:
+            return std::make_unique<graph::HubLabelingRouter<Minutes>>(graph_);
+        case RoutingEngine::MULTILEVEL_OVERLAY:
+            return std::make_unique<graph::MultilevelOverlayRouter<Minutes>>(graph_, thread_pool_.get());
+        case RoutingEngine::COMPACT_ALL_PAIRS:
+            return std::make_unique<graph::CompactRouter<Minutes>>(graph_, thread_pool_.get());
+        case RoutingEngine::AUTO:
+            // the constructor picks an engine before any router is built
+            break;
+    }
+
+    throw std::logic_error("unsupported routing engine"s);
+}
+
+graph::AStarRouter<Minutes>::LowerBound TransportRouter::CreateGeoLowerBound() const {
+    std::optional<double> road_to_geo_ratio;
+    for (const Bus& bus : catalogue_.GetAllBuses()) {
+        for (size_t i = 1; i < bus.stops.size(); ++i) {
+            const double geo_distance =
+                geo::ComputeDistance(bus.stops[i - 1]->coordinates, bus.stops[i]->coordinates);
+            if (geo_distance <= 0.0) {
+                continue;
+            }
+            for (const int road_distance : {catalogue_.GetDistanceBetweenStops(bus.stops[i - 1], bus.stops[i]),
+                                            catalogue_.GetDistanceBetweenStops(bus.stops[i], bus.stops[i - 1])}) {
+                if (road_distance >= 0) {
+                    road_to_geo_ratio = std::min(road_to_geo_ratio.value_or(road_distance / geo_distance),
+                                                 road_distance / geo_distance);
+                }
+            }
+        }
+    }
+
+    // a margin for the rounding of the great-circle formula
+    constexpr double kRoundingMargin = 1.0 - 1e-9;
+    const double minutes_per_meter =
+        road_to_geo_ratio.value_or(0.0) * kRoundingMargin * 60.0 / (1000.0 * settings_.velocity);
+
+    // leaving another stop from its in vertex takes a wait first
+    struct VertexBound {
+        geo::Coordinates coordinates;
+        Minutes wait_time{};
+    };
+    std::vector<VertexBound> vertex_bounds(graph_.GetVertexCount());
+    std::vector<bool> is_stop_vertex(graph_.GetVertexCount(), false);
+    for (const Stop& stop : catalogue_.GetAllStops()) {
+        const VertexIds stop_vertexes = GetStopVertexes(&stop);
+        vertex_bounds[stop_vertexes.in] = {stop.coordinates, static_cast<Minutes>(settings_.wait_time)};
+        vertex_bounds[stop_vertexes.out] = {stop.coordinates, kZeroWaitTime};
+        is_stop_vertex[stop_vertexes.in] = is_stop_vertex[stop_vertexes.out] = true;
+    }
+
+    // an on-board vertex stands at its stop: it's boarded from the stop or alighted to it, or both
+    for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        if (graph_.IsEdgeRemoved(edge_id) || !std::holds_alternative<std::monostate>(edge_items_[edge_id])) {
+            continue;
+        }
+        const auto& edge = graph_.GetEdge(edge_id);
+        if (is_stop_vertex[edge.from]) {
+            vertex_bounds[edge.to] = {vertex_bounds[edge.from].coordinates, kZeroWaitTime};
+        } else {
+            vertex_bounds[edge.from] = {vertex_bounds[edge.to].coordinates, kZeroWaitTime};
+        }
+    }
+
+    return [vertex_bounds = std::move(vertex_bounds), minutes_per_meter](graph::VertexId from, graph::VertexId to) {
+        const VertexBound& from_bound = vertex_bounds[from];
+        const VertexBound& to_bound = vertex_bounds[to];
+        if (from_bound.coordinates == to_bound.coordinates) {
+            return kZeroWaitTime;
+        }
+        return from_bound.wait_time +
+               geo::ComputeDistance(from_bound.coordinates, to_bound.coordinates) * minutes_per_meter;
+    };
+}
+
+bool TransportRouter::LoadFromFile(const RouterOptions& options) {
+    using namespace serialization;
+
+    std::optional<MappedFile> file = MappedFile::Open(options.cache_file);
+    if (!file || file->GetSize() < sizeof(FileHeader)) {
+        return false;
+    }
+
+    FileHeader header{};
+    std::memcpy(&header, file->GetData(), sizeof(header));
+
+    const std::deque<Stop>& stops = catalogue_.GetAllStops();
+    const std::deque<Bus>& buses = catalogue_.GetAllBuses();
+
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.engine != static_cast<uint32_t>(options.engine) ||
+        header.graph_model != static_cast<uint32_t>(options.graph_model) || header.stop_count != stops.size() ||
+        header.checksum != ComputeChecksum(catalogue_, settings_)) {
+        return false;
+    }
+
+    using PrevEdgeId = graph::Router<Minutes>::PrevEdgeId;
+
+    // the counts come from the file, so every section is checked against the bytes left instead of summing
+    // the sizes, which a crafted header could wrap around to the file size
+    size_t remaining_size = file->GetSize() - sizeof(FileHeader);
+    const auto take_section = [&remaining_size](uint64_t count, size_t record_size) {
+        if (count > remaining_size / record_size) {
+            return false;
+        }
+        remaining_size -= static_cast<size_t>(count) * record_size;
+        return true;
+    };
+    if (!take_section(header.edge_count, sizeof(EdgeRecord)) ||
+        !take_section(header.wait_edge_count, sizeof(WaitEdgeRecord)) ||
+        !take_section(header.bus_edge_count, sizeof(BusEdgeRecord)) ||
+        !take_section(header.table_cell_count, sizeof(Minutes) + sizeof(PrevEdgeId)) ||
+        !take_section(header.engine_data_size, 1) || remaining_size != 0) {
+        return false;
+    }
+
+    const char* section = file->GetData() + sizeof(FileHeader);
+    const auto* edges = ReadRecords<EdgeRecord>(section, header.edge_count);
+    const auto* wait_edges = ReadRecords<WaitEdgeRecord>(section, header.wait_edge_count);
+    const auto* bus_edges = ReadRecords<BusEdgeRecord>(section, header.bus_edge_count);
+    const auto* weights = ReadRecords<Minutes>(section, header.table_cell_count);
+    const auto* prev_edges = ReadRecords<PrevEdgeId>(section, header.table_cell_count);
+    const char* engine_data = ReadRecords<char>(section, header.engine_data_size);
+
+    const bool has_table = options.engine == RoutingEngine::ALL_PAIRS;
+    const bool has_engine_data = options.engine == RoutingEngine::CONTRACTION_HIERARCHY ||
+                                 options.engine == RoutingEngine::HUB_LABELING ||
+                                 options.engine == RoutingEngine::MULTILEVEL_OVERLAY ||
+                                 options.engine == RoutingEngine::COMPACT_ALL_PAIRS;
+    // the table has a cell for every two vertexes, told without squaring a count of the file
+    const bool is_table_size_right =
+        !has_table || header.vertex_count == 0
+            ? header.table_cell_count == 0
+            : header.table_cell_count % header.vertex_count == 0 &&
+                  header.table_cell_count / header.vertex_count == header.vertex_count;
+    // every vertex past the two of every stop is an on-board one with edges, which bounds the graph allocated
+    if (header.vertex_count < 2 * stops.size() || header.vertex_count - 2 * stops.size() > 2 * header.edge_count ||
+        !is_table_size_right ||
+        (has_engine_data && header.engine_data_size == 0)) {
+        return false;
+    }
+
+    // the graph is read aside and replaces the one built only when all of it is read
+    graph::DirectedWeightedGraph<Minutes> graph(header.vertex_count);
+    for (size_t i = 0; i < header.edge_count; ++i) {
+        if (edges[i].from >= header.vertex_count || edges[i].to >= header.vertex_count) {
+            return false;
+        }
+        graph.AddEdge({edges[i].from, edges[i].to, edges[i].weight});
+    }
+
+    std::vector<RouteItem> edge_items(header.edge_count, std::monostate{});
+    for (size_t i = 0; i < header.wait_edge_count; ++i) {
+        if (wait_edges[i].edge_id >= header.edge_count || wait_edges[i].stop_index >= stops.size()) {
+            return false;
+        }
+        edge_items[wait_edges[i].edge_id] = WaitInfo{stops[wait_edges[i].stop_index].name, wait_edges[i].time};
+    }
+    for (size_t i = 0; i < header.bus_edge_count; ++i) {
+        if (bus_edges[i].edge_id >= header.edge_count || bus_edges[i].bus_index >= buses.size()) {
+            return false;
+        }
+        edge_items[bus_edges[i].edge_id] = BusRideInfo{
+            buses[bus_edges[i].bus_index].name, static_cast<int>(bus_edges[i].span_count), bus_edges[i].time};
+    }
+
+    std::swap(graph, graph_);
+    std::swap(edge_items, edge_items_);
+
+    // the engine data is checked against the graph as it's read, data that doesn't match is built anew
+    try {
+        if (options.engine == RoutingEngine::ALL_PAIRS) {
+            router_ = std::make_unique<graph::Router<Minutes>>(
+                graph_, graph::Router<Minutes>::Table{weights, prev_edges}, thread_pool_.get());
+            mapped_file_ = std::make_unique<MappedFile>(std::move(*file));
+        } else if (has_engine_data) {
+            std::istringstream input(std::string(engine_data, header.engine_data_size));
+            if (options.engine == RoutingEngine::CONTRACTION_HIERARCHY) {
+                router_ = std::make_unique<graph::ContractionHierarchyRouter<Minutes>>(graph_, input);
+            } else if (options.engine == RoutingEngine::HUB_LABELING) {
+                router_ = std::make_unique<graph::HubLabelingRouter<Minutes>>(graph_, input);
+            } else if (options.engine == RoutingEngine::MULTILEVEL_OVERLAY) {
+                router_ =
+                    std::make_unique<graph::MultilevelOverlayRouter<Minutes>>(graph_, input, thread_pool_.get());
+            } else {
+                router_ = std::make_unique<graph::CompactRouter<Minutes>>(graph_, input);
+            }
+        } else {
+            router_ = CreateRouter(options);
+        }
+    } catch (const std::invalid_argument&) {
+        std::swap(graph, graph_);
+        std::swap(edge_items, edge_items_);
+        return false;
+    } catch (const std::length_error&) {
+        std::swap(graph, graph_);
+        std::swap(edge_items, edge_items_);
+        return false;
+    }
+    vertexes_counter_ = header.vertex_count;
+    stop_count_ = stops.size();
+
+    return true;
+}
+
+bool TransportRouter::SaveToFile(const RouterOptions& options) const {
+    using namespace serialization;
+
+    const std::deque<Stop>& stops = catalogue_.GetAllStops();
+    const std::deque<Bus>& buses = catalogue_.GetAllBuses();
+
+    std::unordered_map<std::string_view, uint64_t> bus_indexes;
+    for (const Bus& bus : buses) {
+        bus_indexes[bus.name] = bus_indexes.size();
+    }
+
+    std::vector<EdgeRecord> edges;
+    edges.reserve(graph_.GetEdgeCount());
+    for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        edges.push_back({edge.from, edge.to, edge.weight});
+    }
+
+    std::vector<WaitEdgeRecord> wait_edges;
+    std::vector<BusEdgeRecord> bus_edges;
+    for (graph::EdgeId edge_id = 0; edge_id < edge_items_.size(); ++edge_id) {
+        if (const auto* wait_info = std::get_if<WaitInfo>(&edge_items_[edge_id])) {
+            wait_edges.push_back({edge_id, catalogue_.GetStop(wait_info->stop_name)->id, wait_info->time});
+        } else if (const auto* ride_info = std::get_if<BusRideInfo>(&edge_items_[edge_id])) {
+            bus_edges.push_back(
+                {edge_id, bus_indexes.at(ride_info->bus_name), ride_info->span_count, ride_info->time});
+        }
+    }
+
+    const auto* all_pairs_router = dynamic_cast<const graph::Router<Minutes>*>(router_.get());
+
+    std::string engine_data;
+    using HierarchyRouter = graph::ContractionHierarchyRouter<Minutes>;
+    if (const auto* hierarchy_router = dynamic_cast<const HierarchyRouter*>(router_.get())) {
+        std::ostringstream output;
+        hierarchy_router->Save(output);
+        engine_data = std::move(output).str();
+    } else if (const auto* hub_labeling_router =
+                   dynamic_cast<const graph::HubLabelingRouter<Minutes>*>(router_.get())) {
+        std::ostringstream output;
+        hub_labeling_router->Save(output);
+        engine_data = std::move(output).str();
+    } else if (const auto* overlay_router =
+                   dynamic_cast<const graph::MultilevelOverlayRouter<Minutes>*>(router_.get())) {
+        std::ostringstream output;
+        overlay_router->Save(output);
+        engine_data = std::move(output).str();
+    } else if (const auto* compact_router = dynamic_cast<const graph::CompactRouter<Minutes>*>(router_.get())) {
+        std::ostringstream output;
+        compact_router->Save(output);
+        engine_data = std::move(output).str();
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.engine = static_cast<uint32_t>(options.engine);
+    header.graph_model = static_cast<uint32_t>(options.graph_model);
+    header.checksum = ComputeChecksum(catalogue_, settings_);
+    header.vertex_count = graph_.GetVertexCount();
+    header.edge_count = edges.size();
+    header.stop_count = stops.size();
+    header.wait_edge_count = wait_edges.size();
+    header.bus_edge_count = bus_edges.size();
+    header.table_cell_count = all_pairs_router ? all_pairs_router->GetCellCount() : 0;
+    header.engine_data_size = engine_data.size();
+
+    // write next to the target and rename, so that a reader never maps a half-written file
+    const std::string temporary_file = options.cache_file + ".tmp"s;
+    {
+        std::ofstream output(temporary_file, std::ios::binary | std::ios::trunc);
+        WriteRecords(output, &header, 1);
+        WriteRecords(output, edges);
+        WriteRecords(output, wait_edges);
+        WriteRecords(output, bus_edges);
+        if (all_pairs_router) {
+            const auto table = all_pairs_router->GetTable();
+            WriteRecords(output, table.weights, header.table_cell_count);
+            WriteRecords(output, table.prev_edges, header.table_cell_count);
+        }
+        WriteRecords(output, engine_data.data(), engine_data.size());
+        output.close();
+        if (!output) {
+            std::remove(temporary_file.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(temporary_file.c_str(), options.cache_file.c_str()) != 0) {
+        std::remove(temporary_file.c_str());
+        return false;
+    }
+    return true;
+}
+
+size_t TransportRouter::CreateVertexes(const TransportCatalogue& catalogue, RouteGraphModel model) {
+    vertexes_counter_ = 2 * catalogue.GetAllStops().size();
+
+    // the on-board vertexes are taken by ConnectStationsOnBoard in the same order, one per stop of every pass
+    size_t on_board_count = 0;
+    if (model == RouteGraphModel::ON_BOARD) {
+        for (const Bus& bus : catalogue.GetAllBuses()) {
+            on_board_count += CountOnBoardVertexes(bus);
+        }
     }
 
-    return vertexes_counter_;
+    return vertexes_counter_ + on_board_count;
 }
 
 void TransportRouter::CreateWaitEdges(const std::deque<Stop>& stops) {
     for (const Stop& stop : stops) {
-        wait_edges_.insert({graph_.AddEdge({vertexes_.at(stop.name).in, vertexes_.at(stop.name).out,
-                                            static_cast<Minutes>(settings_.wait_time)}),
-                            {stop.name, static_cast<Minutes>(settings_.wait_time)}});
+        const Minutes wait_time = static_cast<Minutes>(settings_.wait_time);
+        AddEdge({GetStopVertexes(&stop).in, GetStopVertexes(&stop).out, wait_time}, WaitInfo{stop.name, wait_time});
     }
 }
 
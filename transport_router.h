@@ -1,11 +1,32 @@
 #pragma once
 
+#include <iosfwd>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
 #include <variant>
-
+#include <vector>
+
+#include "astar_router.h"
+#include "bidirectional_dijkstra_router.h"
+#include "bounded_search.h"
+#include "compact_router.h"
+#include "contraction_hierarchy_router.h"
+#include "csr_graph.h"
+#include "dijkstra_router.h"
 #include "domain.h"
+#include "fixed_point_router.h"
 #include "graph.h"
+#include "hub_labeling_router.h"
+#include "k_shortest_paths.h"
+#include "lru_cache.h"
+#include "multilevel_overlay_router.h"
+#include "pareto_search.h"
 #include "router.h"
+#include "router_serialization.h"
+#include "thread_pool.h"
 #include "transport_catalogue.h"
 
 namespace transport_catalogue {
@@ -19,8 +40,81 @@ struct VertexIds {
     graph::VertexId out{};
 };
 
+// the stops take the first vertexes, two each in the order of their ids, the on-board vertexes follow
+inline VertexIds GetStopVertexes(StopPtr stop) {
+    return {2 * stop->id, 2 * stop->id + 1};
+}
+
 constexpr Minutes kZeroWaitTime{};
 
+// the step of the integer weights of the fixed-point engine
+constexpr Minutes kFixedPointUnit = 1.0 / 600.0;
+
+enum class RoutingEngine {
+    // precomputes every route at construction, quadratic memory
+    ALL_PAIRS,
+    // searches on every request, linear memory and fast construction
+    DIJKSTRA,
+    // preprocesses a contraction hierarchy, near linear memory and sub-millisecond queries on big networks
+    CONTRACTION_HIERARCHY,
+    // searches on every request towards the destination by a great-circle lower bound, linear memory
+    ASTAR,
+    // searches on every request from both ends at once, linear memory
+    BIDIRECTIONAL_DIJKSTRA,
+    // searches on every request over integer weights in kFixedPointUnit with a radix heap, the times
+    // are summed back in minutes along the found route; rounding the edges may pick a route slower than
+    // the fastest one by half a unit per edge of both, so over STOP_TO_STOP a printed total may differ from
+    // ALL_PAIRS in its last digit. Only taken when named, never by AUTO or by default
+    FIXED_POINT_DIJKSTRA,
+    // precomputes hub labels of every vertex, a query merges two sorted labels without searching;
+    // the longest preprocessing and the fastest queries of the memory-light engines
+    HUB_LABELING,
+    // cliques over a multilevel partition, a change of the routing settings only customizes them anew
+    MULTILEVEL_OVERLAY,
+    // like ALL_PAIRS, but keeps only the last edge of every route, 2 or 4 bytes instead of 12
+    COMPACT_ALL_PAIRS,
+    // picks ALL_PAIRS, COMPACT_ALL_PAIRS or CONTRACTION_HIERARCHY, the first within the budgets of
+    // RouterOptions, else DIJKSTRA
+    AUTO,
+};
+
+// the names of the engines in the settings, the enumerators in lower case, e.g. "compact_all_pairs"
+std::string_view GetRoutingEngineName(RoutingEngine engine);
+
+std::optional<RoutingEngine> ParseRoutingEngine(std::string_view name);
+
+enum class RouteGraphModel {
+    // an edge from every stop of a bus to every later one, two vertexes per stop
+    STOP_TO_STOP,
+    // a vertex per stop of every bus pass joined by ride edges, linear edges per bus but many more vertexes;
+    // a route is picked among the fastest ones as STOP_TO_STOP picks it, which costs a search per request
+    ON_BOARD,
+};
+
+struct RouterOptions {
+    RoutingEngine engine = RoutingEngine::ALL_PAIRS;
+    RouteGraphModel graph_model = RouteGraphModel::STOP_TO_STOP;
+    // threads used to build the router, to answer route matrices and to search alternative routes,
+    // 0 means all hardware threads and 1 runs everything on the calling thread
+    size_t thread_count = 0;
+    // if set, the router is loaded from this file when it matches the catalogue and the settings,
+    // otherwise it is built and saved there
+    std::string cache_file;
+    // the routes of this many stop pairs are kept for repeated Route requests, 0 turns the cache off;
+    // the all-pairs engines read a route from their tables faster than from the cache and have none
+    size_t route_cache_capacity = 10000;
+    // the bytes the AUTO engine may give the tables and indexes of the router
+    size_t memory_budget = size_t{1} << 30;
+    // the seconds the AUTO engine may give the build of a table or a hierarchy, estimated by the vertexes
+    // and the edges
+    double build_time_budget = 60.0;
+    // if set, AUTO writes the estimates it picked the engine by there, and the router reports a cache file
+    // it can't write
+    std::ostream* log = nullptr;
+};
+
+// the const queries may run concurrently on any number of threads without locking: the engines keep
+// no mutable state and search in per-thread workspaces, and the thread pool takes tasks from many threads
 class TransportRouter {
 public:
     struct BusRideInfo {
@@ -36,57 +130,226 @@ public:
 
     using RouteItem = std::variant<std::monostate, WaitInfo, BusRideInfo>;
 
+    // total time and items of a route
+    using Route = std::pair<Minutes, std::vector<RouteItem>>;
+
+    // routes from every origin (rows) to every destination (columns), nullopt where there is none
+    using RouteMatrix = std::vector<std::vector<std::optional<Route>>>;
+
+    enum class IsochroneDirection {
+        // the stops reachable from the stop
+        FROM_STOP,
+        // the stops the stop is reachable from
+        TO_STOP,
+    };
+
+    struct ReachableStop {
+        std::string_view stop_name;
+        Minutes time{};
+    };
+
 public:
-    TransportRouter(const transport_catalogue::TransportCatalogue& catalogue, const RoutingSettings& settings);
+    TransportRouter(const transport_catalogue::TransportCatalogue& catalogue, const RoutingSettings& settings,
+                    const RouterOptions& options = {});
 
+    // the routes are cached by stop pair until the next update
     std::optional<std::pair<Minutes, std::vector<RouteItem>>> GetRouteInfo(StopPtr stop_from,
                                                                            StopPtr stop_to) const;
 
+    // the engine the router was built with, the one AUTO picked
+    RoutingEngine GetEngine() const { return options_.engine; }
+
+    // the hits and misses of GetRouteInfo in the route cache, zeros without the cache
+    concurrency::CacheStats GetRouteCacheStats() const;
+
+    RouteMatrix GetRouteMatrix(const std::vector<StopPtr>& stops_from, const std::vector<StopPtr>& stops_to,
+                               bool with_items) const;
+
+    // the stops within max_time of the stop, the stop itself included, in the order of their times;
+    // one search that stops at max_time
+    std::vector<ReachableStop> GetIsochrone(StopPtr stop, Minutes max_time, IsochroneDirection direction) const;
+
+    // the best route and up to alternative_count more loopless routes in the order of their times,
+    // none longer than the best one by more than max_time_gap
+    std::vector<Route> GetAlternativeRoutes(StopPtr stop_from, StopPtr stop_to, size_t alternative_count,
+                                            Minutes max_time_gap) const;
+
+    // the routes no other route beats both in time and in the number of boardings, none boarding more than
+    // max_boardings times, in the order of their times
+    std::vector<Route> GetParetoRoutes(StopPtr stop_from, StopPtr stop_to, size_t max_boardings) const;
+
+    // patches only the edges of the buses that changed in the catalogue, or rebuilds the router when stops
+    // were added; must not run along with any query
+    void UpdateBuses(const std::vector<BusPtr>& buses);
+
+    // the same for the buses that pass both stops after the distance between them changed
+    void UpdateDistance(StopPtr stop_from, StopPtr stop_to);
+
+    // reweights the edges for the new wait time and bus velocity; must not run along with any query
+    void UpdateRoutingSettings(const RoutingSettings& settings);
+
 private:
-    void CreateEdges(const TransportCatalogue& catalogue) {
+    // a cached route is shared, so a hit copies it outside the lock of the cache
+    using RouteCache = concurrency::LruCache<std::pair<StopPtr, StopPtr>,
+                                             std::shared_ptr<const std::optional<Route>>, DistanceBetweenStopsHash>;
+
+    std::optional<Route> FindRoute(StopPtr stop_from, StopPtr stop_to) const;
+
+    void BuildGraph();
+
+    // builds the graph, the router and the search graphs anew from the catalogue
+    void Rebuild();
+
+    // the searches that don't depend on the engine, over copies of the graph along and against its edges
+    struct GraphSearches {
+        GraphSearches(const graph::DirectedWeightedGraph<Minutes>& graph, const std::vector<RouteItem>& edge_items);
+
+        // the searches refer to the graphs next to them
+        GraphSearches(const GraphSearches&) = delete;
+        GraphSearches& operator=(const GraphSearches&) = delete;
+
+        graph::CsrGraph<Minutes> forward_graph;
+        graph::CsrGraph<Minutes> backward_graph;
+        // flags the edges a route boards by, the waits in both models
+        std::vector<bool> boarding_edges;
+        graph::BoundedSearch<Minutes> bounded_search;
+        graph::KShortestPaths<Minutes> k_shortest_paths;
+        graph::ParetoSearch<Minutes> pareto_search;
+    };
+
+    // built by the first request that searches them, the updates drop them
+    const GraphSearches& GetGraphSearches() const;
+
+    // patches the current edges of some buses to the edges of the graph, which holds what those buses give
+    // now, returns the ids of the added, removed and reweighted edges
+    std::vector<graph::EdgeId> PatchEdges(const std::vector<graph::EdgeId>& current_edge_ids,
+                                          const graph::DirectedWeightedGraph<Minutes>& graph,
+                                          const std::vector<RouteItem>& edge_items);
+
+    Route UnpackRoute(const graph::RouterBase<Minutes>::RouteInfo& route_info) const;
+
+    // an edge of the stop-to-stop model: a wait, or a ride from the out vertex of a stop to the in vertex of
+    // a later one, which the on-board model splits into segments
+    struct StopToStopEdge {
+        graph::VertexId from{};
+        graph::VertexId to{};
+        Minutes weight{};
+        RouteItem item;
+    };
+
+    // the stop-to-stop edges on the fastest routes from a stop, in the order the stop-to-stop model adds them,
+    // and the edges into every vertex they reach
+    struct FastestEdges {
+        graph::VertexId from{};
+        std::vector<StopToStopEdge> edges;
+        std::unordered_map<graph::VertexId, std::vector<size_t>> incoming_edges;
+    };
+
+    // the edges of the on-board graph within max_time of the stop, found by one bounded search
+    FastestEdges FindFastestEdges(StopPtr stop_from, Minutes max_time) const;
+
+    // the route to the stop as the all-pairs table of the stop-to-stop model has it: of the routes of the same
+    // time it keeps the first found and it sums a route in the order it joins the parts; none if not reached
+    std::optional<Route> PickStopToStopRoute(const FastestEdges& fastest_edges, StopPtr stop_to) const;
+
+    // the engine AUTO picks for the graph built, written to options.log with the estimates it was picked by
+    static RoutingEngine ChooseEngine(size_t vertex_count, size_t edge_count, const RouterOptions& options);
+
+    std::unique_ptr<graph::RouterBase<Minutes>> CreateRouter(const RouterOptions& options) const;
+
+    // lower bound of the travel time between two vertexes: the great-circle distance at the bus velocity,
+    // scaled by the least ratio of road to great-circle distance, plus the wait before boarding
+    graph::AStarRouter<Minutes>::LowerBound CreateGeoLowerBound() const;
+
+    // returns false if the file is missing, of another version or built for another input
+    bool LoadFromFile(const RouterOptions& options);
+
+    // returns false if the file can't be written, e.g. in a read-only directory or on a full disk
+    bool SaveToFile(const RouterOptions& options) const;
+
+    void CreateEdges(const TransportCatalogue& catalogue, RouteGraphModel model) {
         CreateWaitEdges(catalogue.GetAllStops());
-        CreateBusEdges(catalogue);
+        CreateBusEdges(catalogue, model);
     }
 
-    size_t CreateVertexes(const std::deque<Stop>& stops);
+    size_t CreateVertexes(const TransportCatalogue& catalogue, RouteGraphModel model);
 
     void CreateWaitEdges(const std::deque<Stop>& stops);
 
-    void CreateBusEdges(const TransportCatalogue& catalogue) {
+    void CreateBusEdges(const TransportCatalogue& catalogue, RouteGraphModel model) {
         for (const Bus& bus : catalogue.GetAllBuses()) {
-            ConnectStations(bus.stops.begin(), bus.stops.end(), bus.name);
+            ConnectBus(bus, model);
+        }
+    }
 
-            if (!bus.is_circular) {
-                ConnectStations(bus.stops.rbegin(), bus.stops.rend(), bus.name);
-            }
+    void ConnectBus(const Bus& bus, RouteGraphModel model) {
+        ConnectStations(bus.stops.begin(), bus.stops.end(), bus.name, model);
+
+        if (!bus.is_circular) {
+            ConnectStations(bus.stops.rbegin(), bus.stops.rend(), bus.name, model);
         }
     }
 
+    // the number of on-board vertexes a bus takes in the on-board model
+    static size_t CountOnBoardVertexes(const Bus& bus) {
+        return bus.is_circular ? bus.stops.size() : 2 * bus.stops.size();
+    }
+
     template <typename It>
-    void ConnectStations(It begin, It end, std::string_view bus_name) {
+    void ConnectStations(It begin, It end, std::string_view bus_name, RouteGraphModel model) {
+        if (model == RouteGraphModel::ON_BOARD) {
+            ConnectStationsOnBoard(begin, end, bus_name);
+            return;
+        }
+
         for (auto from_it = begin; from_it != std::prev(end); ++from_it) {
             Minutes weight{};
             int span_count{};
 
             for (auto to_it = std::next(from_it); to_it != end; ++to_it) {
-                std::string_view departure_name = (*from_it)->name;
-
-                graph::VertexId departure = vertexes_.at(departure_name).out;
-
-                std::string_view arrival_name = (*to_it)->name;
+                graph::VertexId departure = GetStopVertexes(*from_it).out;
 
-                graph::VertexId arrival = vertexes_.at(arrival_name).in;
+                graph::VertexId arrival = GetStopVertexes(*to_it).in;
 
                 weight += CalculateTimeBetweenStations(*prev(to_it), *(to_it));
                 ++span_count;
 
-                auto bus_edge_id = graph_.AddEdge({departure, arrival, weight});
+                AddEdge({departure, arrival, weight}, BusRideInfo{bus_name, span_count, weight});
+            }
+        }
+    }
+
+    // the wait stays on the edge from the stop's in vertex to its out one, so boarding and alighting
+    // are free and the stop vertexes are the same as in the stop-to-stop model
+    template <typename It>
+    void ConnectStationsOnBoard(It begin, It end, std::string_view bus_name) {
+        std::optional<graph::VertexId> prev_on_board;
+
+        for (auto it = begin; it != end; ++it) {
+            const VertexIds stop_vertexes = GetStopVertexes(*it);
+            const graph::VertexId on_board = GenereateNewVertexId();
 
-                bus_edges_[bus_edge_id] = {bus_name, span_count, weight};
+            if (prev_on_board) {
+                const Minutes time = CalculateTimeBetweenStations(*std::prev(it), *it);
+                AddEdge({*prev_on_board, on_board, time}, BusRideInfo{bus_name, 1, time});
             }
+            if (std::next(it) != end) {
+                AddEdge({stop_vertexes.out, on_board, kZeroWaitTime}, std::monostate{});
+            }
+            if (it != begin) {
+                AddEdge({on_board, stop_vertexes.in, kZeroWaitTime}, std::monostate{});
+            }
+
+            prev_on_board = on_board;
         }
     }
 
+    // adds the edge to the graph and what it stands for to edge_items_ under the same id
+    graph::EdgeId AddEdge(const graph::Edge<Minutes>& edge, RouteItem item) {
+        edge_items_.push_back(std::move(item));
+        return graph_.AddEdge(edge);
+    }
+
     Minutes CalculateTimeBetweenStations(StopPtr from, StopPtr to) const;
 
     graph::VertexId GenereateNewVertexId() { return vertexes_counter_++; }
@@ -96,19 +359,31 @@ private:
 
     RoutingSettings settings_;
 
+    RouterOptions options_;
+
+    std::unique_ptr<concurrency::ThreadPool> thread_pool_;
+
     graph::DirectedWeightedGraph<Minutes> graph_;
 
-    std::unique_ptr<graph::Router<Minutes>> router_;
+    // keeps the tables of a router loaded from a file
+    std::unique_ptr<serialization::MappedFile> mapped_file_;
+
+    std::unique_ptr<graph::RouterBase<Minutes>> router_;
+
+    mutable std::mutex graph_searches_mutex_;
+    mutable std::unique_ptr<const GraphSearches> graph_searches_;
 
-    std::unordered_map<std::string_view, VertexIds> vertexes_;
+    // none if the cache is off
+    std::unique_ptr<RouteCache> route_cache_;
 
     graph::VertexId vertexes_counter_ = 0;
 
-    // use this containers to remember which are wait edges
-    std::unordered_map<graph::EdgeId, WaitInfo> wait_edges_;
+    // the stops the graph has vertexes for
+    size_t stop_count_ = 0;
 
-    // use this containers to remember which are ride edges
-    std::unordered_map<graph::EdgeId, BusRideInfo> bus_edges_;
+    // what every edge stands for, indexed by the edge id: a wait, a ride or, for boarding and alighting,
+    // nothing
+    std::vector<RouteItem> edge_items_;
 };
 
 }  // namespace router